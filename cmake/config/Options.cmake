@@ -7,3 +7,13 @@ option(${${PROJECT_NAME}_UPPER}_ENABLE_DEMOS
   "Build the ${PROJECT_NAME} demos."
   OFF
   )
+
+option(${${PROJECT_NAME}_UPPER}_ENABLE_BENCHMARKS
+  "Build the ${PROJECT_NAME} benchmarks."
+  OFF
+  )
+
+option(${${PROJECT_NAME}_UPPER}_ENABLE_PERF_TESTS
+  "Build the ${PROJECT_NAME} soak and throughput tests, labelled 'perf' in CTest."
+  OFF
+  )
@@ -0,0 +1,447 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_CONVERSION_CONVERTER
+#define DABDEVICE_CONVERSION_CONVERTER
+
+#include "dab/conversion/kernels.h"
+#include "dab/conversion/lookup_table.h"
+#include "dab/transport/sink.h"
+#include "dab/types/block_metadata.h"
+#include "dab/types/frequency.h"
+#include "dab/types/gain.h"
+
+#include <dab/types/common_types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace conversion
+    {
+
+    /**
+     * @brief The outcome of delivering a block of samples into a sink
+     *
+     * @since 1.1.0
+     */
+    struct delivery
+      {
+      /**
+       * @brief The number of new samples accepted by the sink
+       */
+      std::size_t delivered;
+
+      /**
+       * @brief The number of previously buffered samples that were discarded to make room
+       */
+      std::size_t discarded;
+      };
+
+    /**
+     * @brief The raw sample converter used by the RTL devices
+     *
+     * Without a calibration source, the converter uses the fastest conversion kernel available on the
+     * executing CPU. Once a calibration source has been installed, it converts through a
+     * dab::conversion::lookup_table that corrects DC offset and I/Q imbalance. The table is rebuilt whenever
+     * the device reports a new center frequency or gain that results in a different calibration. Rebuilding
+     * happens on the thread reporting the change, while the acquisition thread keeps using the previous table
+     * until the new one is ready.
+     *
+     * @since 1.1.0
+     */
+    struct converter
+      {
+      /**
+       * @brief Convert @p nofSamples interleaved raw I/Q pairs starting at @p raw into @p samples
+       *
+       * This function is safe to call concurrently with any of the calibration related functions.
+       */
+      void convert(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples) const
+        {
+        reader const guard{*this};
+        if(auto const table = guard.table())
+          {
+          table->convert(raw, nofSamples, samples);
+          }
+        else
+          {
+          conversion::convert(raw, nofSamples, samples);
+          }
+        }
+
+      /**
+       * @brief Convert @p nofSamples interleaved raw I/Q pairs starting at @p raw into Q15 fixed-point @p samples
+       *
+       * This function is safe to call concurrently with any of the calibration related functions.
+       */
+      void convert(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples) const
+        {
+        reader const guard{*this};
+        if(auto const table = guard.table())
+          {
+          table->convert(raw, nofSamples, samples);
+          }
+        else
+          {
+          conversion::convert(raw, nofSamples, samples);
+          }
+        }
+
+      /**
+       * @brief Deliver @p nofSamples interleaved raw I/Q pairs starting at @p raw into @p output
+       *
+       * The samples are written straight into the storage reserved in the sink, in the format requested by
+       * the sink. Sinks accepting dab::raw_sample receive the raw bytes unchanged, so the calibration is not
+       * applied to them. If the sink runs out of room, @p policy decides how to proceed. When samples are
+       * dropped, the sink is informed about the discontinuity.
+       *
+       * @param running While waiting for room under dab::overflow_policy::block, the converter gives up once
+       * this flag is cleared. Without a flag, it waits until the consumer makes room.
+       */
+      delivery deliver(sink & output, std::uint8_t const * raw, std::size_t nofSamples,
+                       overflow_policy const policy = overflow_policy::drop_newest,
+                       std::atomic_bool const * running = nullptr) const
+        {
+        switch(output.format())
+          {
+          case sample_format::raw_uint8:
+            return fill(static_cast<raw_sink &>(output), raw, nofSamples, policy, running);
+          case sample_format::complex_int16:
+            return fill(static_cast<fixed_sink &>(output), raw, nofSamples, policy, running);
+          default:
+            return fill(static_cast<sample_sink &>(output), raw, nofSamples, policy, running);
+          }
+        }
+
+      /**
+       * @brief Describe the next @p nofSamples raw samples to @p output, right before delivering them
+       *
+       * Devices call this function on their acquisition thread for every block of raw samples they are about to
+       * #deliver. The metadata carries @p captured, the index of the first sample in the stream of announced
+       * samples, and the current center frequency and gain. The first block, and every block whose center
+       * frequency or gain differ from those of the previous block, is flagged as retuned, and the retune is
+       * reported to @p output as well.
+       */
+      void announce(sink & output, std::size_t const nofSamples, std::chrono::steady_clock::time_point const captured)
+        {
+        auto const centerFrequency = m_currentFrequency.load(std::memory_order_relaxed);
+        auto const currentGain = m_currentGain.load(std::memory_order_relaxed);
+        auto flags = std::uint32_t{};
+
+        if(!m_announced || centerFrequency != m_announcedFrequency || currentGain != m_announcedGain)
+          {
+          flags = block_metadata::kRetuned;
+          output.retuned(frequency{centerFrequency});
+          }
+
+        m_announced = true;
+        m_announcedFrequency = centerFrequency;
+        m_announcedGain = currentGain;
+
+        auto const timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(captured.time_since_epoch()).count();
+        output.acquired(block_metadata{0, m_nextSample, timestamp, centerFrequency, currentGain, flags});
+        m_nextSample += nofSamples;
+        }
+
+      /**
+       * @brief Report @p nofSamples raw samples that were acquired but deliberately not delivered to @p output
+       *
+       * The samples are reported to @p output as a discontinuity, and the index of the next announced sample is
+       * advanced past them, so that the metadata of the following blocks keeps counting acquired samples.
+       */
+      void skip(sink & output, std::size_t const nofSamples)
+        {
+        if(nofSamples)
+          {
+          output.discontinuity(nofSamples);
+          m_nextSample += nofSamples;
+          }
+        }
+
+      /**
+       * @brief Check whether the converter can deliver samples into the given sink
+       */
+      static bool supports(sink const & output)
+        {
+        switch(output.format())
+          {
+          case sample_format::complex_float:
+          case sample_format::raw_uint8:
+          case sample_format::complex_int16:
+            return true;
+          default:
+            return false;
+          }
+        }
+
+      /**
+       * @brief Reject sinks whose format the converter can not produce
+       *
+       * @throws std::invalid_argument if the format of @p output is not supported
+       */
+      static sink & check(sink & output)
+        {
+        if(!supports(output))
+          {
+          throw std::invalid_argument{"Unsupported sample format!"};
+          }
+
+        return output;
+        }
+
+      /**
+       * @brief Install a new calibration source
+       *
+       * Passing an empty source removes the current calibration and switches back to uncorrected conversion.
+       */
+      void calibrate(calibration_source source)
+        {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_source = std::move(source);
+        rebuild();
+        }
+
+      /**
+       * @brief Check if a calibration source is installed
+       */
+      bool calibrated() const
+        {
+        return m_current.load() != nullptr;
+        }
+
+      /**
+       * @brief Notify the converter about a new center frequency
+       */
+      void update(frequency const centerFrequency)
+        {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_frequency = centerFrequency;
+        m_currentFrequency.store(static_cast<std::uint32_t>(centerFrequency), std::memory_order_relaxed);
+        rebuild();
+        }
+
+      /**
+       * @brief Notify the converter about a new receiver gain
+       */
+      void update(gain const gain)
+        {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_gain = gain;
+        m_currentGain.store(gain.value(), std::memory_order_relaxed);
+        rebuild();
+        }
+
+      private:
+        /**
+         * @internal
+         *
+         * @brief Fill reservations of @p output until all samples are delivered or the overflow policy gives up
+         */
+        template<typename SampleType>
+        delivery fill(basic_sink<SampleType> & output, std::uint8_t const * raw, std::size_t nofSamples,
+                      overflow_policy const policy, std::atomic_bool const * running) const
+          {
+          auto result = delivery{};
+          while(result.delivered < nofSamples)
+            {
+            auto count = nofSamples - result.delivered;
+            auto const target = output.reserve(count);
+            if(!target)
+              {
+              if(make_room(output, policy, running, result.discarded))
+                {
+                continue;
+                }
+
+              output.discontinuity(nofSamples - result.delivered);
+              break;
+              }
+
+            convert(raw + 2 * result.delivered, count, target);
+            output.commit(count);
+            result.delivered += count;
+            }
+
+          return result;
+          }
+
+        /**
+         * @internal
+         *
+         * @brief Make room in the full sink @p output as prescribed by @p policy
+         *
+         * @return @c true if there is room for new samples, @c false if they have to be dropped
+         */
+        static bool make_room(sink & output, overflow_policy const policy, std::atomic_bool const * running,
+                              std::size_t & discarded)
+          {
+          // The interval in which a blocked producer checks whether it should give up
+          auto const pollInterval = std::chrono::milliseconds{10};
+
+          switch(policy)
+            {
+            case overflow_policy::block:
+              while(!running || running->load(std::memory_order_acquire))
+                {
+                if(output.wait_for_room(pollInterval))
+                  {
+                  return true;
+                  }
+                }
+              return false;
+            case overflow_policy::drop_oldest:
+              if(auto const count = output.discard_oldest())
+                {
+                discarded += count;
+                return true;
+                }
+              return false;
+            default:
+              return false;
+            }
+          }
+
+        /**
+         * @internal
+         *
+         * @brief Copy raw samples unchanged, as they are neither normalized nor calibrated
+         */
+        void convert(std::uint8_t const * raw, std::size_t nofSamples, raw_sample * samples) const
+          {
+          std::memcpy(samples, raw, nofSamples * sizeof(raw_sample));
+          }
+
+        /**
+         * @internal
+         *
+         * @brief Rebuild the lookup table if the calibration for the current settings changed
+         */
+        void rebuild()
+          {
+          if(!m_source)
+            {
+            publish(nullptr);
+            return;
+            }
+
+          auto const calibration = m_source(m_frequency, m_gain);
+          if(!m_table || m_table->calibration() != calibration)
+            {
+            publish(std::make_shared<lookup_table const>(calibration));
+            }
+          }
+
+        /**
+         * @internal
+         *
+         * @brief Make @p table the table used for conversion
+         *
+         * The previous table is released once no conversion is using it anymore. Conversions are short, so the
+         * wait is usually over after at most a single block.
+         */
+        void publish(std::shared_ptr<lookup_table const> table)
+          {
+          auto const retired = std::move(m_table);
+          m_table = std::move(table);
+          m_current.store(m_table.get());
+
+          while(m_readers.load())
+            {
+            std::this_thread::yield();
+            }
+          }
+
+        /**
+         * @internal
+         *
+         * @brief Keeps the table a conversion started with alive until the conversion is done
+         *
+         * Announcing the reader before loading the table ensures that #publish either sees the reader, or the
+         * reader sees the new table. This avoids taking a lock, or going through the lock pool that
+         * std::atomic_load uses for std::shared_ptr, for every converted block.
+         */
+        struct reader
+          {
+          explicit reader(converter const & owner) :
+            m_readers{owner.m_readers}
+            {
+            m_readers.fetch_add(1);
+            m_used = owner.m_current.load();
+            }
+
+          reader(reader const &) = delete;
+          reader & operator=(reader const &) = delete;
+
+          ~reader()
+            {
+            m_readers.fetch_sub(1);
+            }
+
+          lookup_table const * table() const
+            {
+            return m_used;
+            }
+
+          private:
+            std::atomic<std::size_t> & m_readers;
+            lookup_table const * m_used;
+          };
+
+        std::mutex m_mutex{};
+        calibration_source m_source{};
+        frequency m_frequency{0};
+        gain m_gain{0.0f};
+        std::shared_ptr<lookup_table const> m_table{};
+        std::atomic<lookup_table const *> m_current{};
+        mutable std::atomic<std::size_t> m_readers{};
+        std::atomic<std::uint32_t> m_currentFrequency{};
+        std::atomic<float> m_currentGain{};
+        std::uint64_t m_nextSample{};
+        std::uint32_t m_announcedFrequency{};
+        float m_announcedGain{};
+        bool m_announced{};
+      };
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_CONVERSION_KERNELS
+#define DABDEVICE_CONVERSION_KERNELS
+
+#include "dab/types/fixed_sample.h"
+#include "dab/types/raw_sample.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DABDEVICE_CONVERSION_X86 1
+#include <immintrin.h>
+#endif
+
+namespace dab
+  {
+
+  /**
+   * @namespace conversion
+   *
+   * @brief This namespace contains the kernels used to convert raw samples into their normalized form.
+   */
+  namespace conversion
+    {
+
+    /**
+     * @brief The instruction set extensions a conversion kernel can be built for
+     *
+     * @since 1.1.0
+     */
+    enum struct isa : std::uint8_t
+      {
+      scalar, ///< Portable C++, no instruction set extensions
+      sse2, ///< x86 SSE2
+      avx2, ///< x86 AVX2
+      avx512, ///< x86 AVX-512 Foundation
+      };
+
+    /**
+     * @brief The signature of all u8 IQ to complex float conversion kernels
+     *
+     * A kernel converts @p nofSamples interleaved unsigned 8-bit I/Q pairs starting at @p raw into
+     * normalized complex samples starting at @p samples. Neither pointer has to be aligned.
+     *
+     * @since 1.1.0
+     */
+    using kernel = void (*)(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples);
+
+    /**
+     * @brief The signature of all u8 IQ to Q15 fixed-point conversion kernels
+     *
+     * A fixed-point kernel converts @p nofSamples interleaved unsigned 8-bit I/Q pairs starting at @p raw into
+     * Q15 complex samples starting at @p samples. Neither pointer has to be aligned.
+     *
+     * @since 1.1.0
+     */
+    using fixed_kernel = void (*)(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples);
+
+    /**
+     * @brief The scalar reference kernel
+     *
+     * Every component is mapped to (x - 128) / 128. All other kernels produce bit-identical results, since
+     * the integer subtraction and its conversion to float are exact and the division by a power of two is
+     * equivalent to a multiplication by its reciprocal.
+     *
+     * @since 1.1.0
+     */
+    inline void convert_scalar(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples)
+      {
+      for(std::size_t idx = 0; idx < nofSamples; ++idx)
+        {
+        float floating_real = raw[2 * idx];
+        float floating_imag = raw[2 * idx + 1];
+        samples[idx] = dab::internal::sample_t{(floating_real - 128) / 128, (floating_imag - 128) / 128};
+        }
+      }
+
+    /**
+     * @brief The scalar reference fixed-point kernel
+     *
+     * Every component is mapped to (x - 128) * 256. Since this is an exact integer operation, all other
+     * fixed-point kernels produce identical results.
+     *
+     * @since 1.1.0
+     */
+    inline void convert_fixed_scalar(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples)
+      {
+      for(std::size_t idx = 0; idx < nofSamples; ++idx)
+        {
+        auto const real = static_cast<std::int16_t>((raw[2 * idx] - 128) * 256);
+        auto const imag = static_cast<std::int16_t>((raw[2 * idx + 1] - 128) * 256);
+        samples[idx] = fixed_sample{real, imag};
+        }
+      }
+
+#if defined(DABDEVICE_CONVERSION_X86)
+    /**
+     * @brief The SSE2 kernel, converting 8 samples per iteration
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("sse2")))
+    inline void convert_sse2(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples)
+      {
+      auto const zero = _mm_setzero_si128();
+      auto const offset = _mm_set1_epi16(128);
+      auto const scale = _mm_set1_ps(1.0f / 128);
+      auto output = reinterpret_cast<float *>(samples);
+
+      std::size_t idx{};
+      for(; idx + 8 <= nofSamples; idx += 8)
+        {
+        auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx));
+        auto const low = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), offset);
+        auto const high = _mm_sub_epi16(_mm_unpackhi_epi8(bytes, zero), offset);
+
+        auto const first = _mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16);
+        auto const second = _mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16);
+        auto const third = _mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16);
+        auto const fourth = _mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16);
+
+        _mm_storeu_ps(output + 2 * idx, _mm_mul_ps(_mm_cvtepi32_ps(first), scale));
+        _mm_storeu_ps(output + 2 * idx + 4, _mm_mul_ps(_mm_cvtepi32_ps(second), scale));
+        _mm_storeu_ps(output + 2 * idx + 8, _mm_mul_ps(_mm_cvtepi32_ps(third), scale));
+        _mm_storeu_ps(output + 2 * idx + 12, _mm_mul_ps(_mm_cvtepi32_ps(fourth), scale));
+        }
+
+      convert_scalar(raw + 2 * idx, nofSamples - idx, samples + idx);
+      }
+
+    /**
+     * @brief The AVX2 kernel, converting 16 samples per iteration
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("avx2")))
+    inline void convert_avx2(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples)
+      {
+      auto const offset = _mm256_set1_epi32(128);
+      auto const scale = _mm256_set1_ps(1.0f / 128);
+      auto output = reinterpret_cast<float *>(samples);
+
+      std::size_t idx{};
+      for(; idx + 16 <= nofSamples; idx += 16)
+        {
+        for(std::size_t part = 0; part < 4; ++part)
+          {
+          auto const bytes = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(raw + 2 * idx + 8 * part));
+          auto const integers = _mm256_sub_epi32(_mm256_cvtepu8_epi32(bytes), offset);
+          _mm256_storeu_ps(output + 2 * idx + 8 * part, _mm256_mul_ps(_mm256_cvtepi32_ps(integers), scale));
+          }
+        }
+
+      convert_sse2(raw + 2 * idx, nofSamples - idx, samples + idx);
+      }
+
+    // The unmasked AVX-512 intrinsics of GCC pass an undefined vector as the merge source, which GCC mistakes for
+    // a read of an uninitialized value.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    /**
+     * @brief The AVX-512 kernel, converting 32 samples per iteration
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("avx512f")))
+    inline void convert_avx512(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples)
+      {
+      auto const offset = _mm512_set1_epi32(128);
+      auto const scale = _mm512_set1_ps(1.0f / 128);
+      auto output = reinterpret_cast<float *>(samples);
+
+      std::size_t idx{};
+      for(; idx + 32 <= nofSamples; idx += 32)
+        {
+        for(std::size_t part = 0; part < 4; ++part)
+          {
+          auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx + 16 * part));
+          auto const integers = _mm512_sub_epi32(_mm512_cvtepu8_epi32(bytes), offset);
+          _mm512_storeu_ps(output + 2 * idx + 16 * part, _mm512_mul_ps(_mm512_cvtepi32_ps(integers), scale));
+          }
+        }
+
+      convert_sse2(raw + 2 * idx, nofSamples - idx, samples + idx);
+      }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    /**
+     * @brief The SSE2 fixed-point kernel, converting 8 samples per iteration
+     *
+     * Flipping the sign bit of a raw byte yields x - 128 as a signed byte. Interleaving these bytes with zeros
+     * places them in the upper half of 16-bit words, which multiplies them by 256.
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("sse2")))
+    inline void convert_fixed_sse2(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples)
+      {
+      auto const zero = _mm_setzero_si128();
+      auto const sign = _mm_set1_epi8(static_cast<char>(0x80));
+      auto output = reinterpret_cast<std::int16_t *>(samples);
+
+      std::size_t idx{};
+      for(; idx + 8 <= nofSamples; idx += 8)
+        {
+        auto const bytes = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx)), sign);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 2 * idx), _mm_unpacklo_epi8(zero, bytes));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 2 * idx + 8), _mm_unpackhi_epi8(zero, bytes));
+        }
+
+      convert_fixed_scalar(raw + 2 * idx, nofSamples - idx, samples + idx);
+      }
+
+    /**
+     * @brief The AVX2 fixed-point kernel, converting 16 samples per iteration
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("avx2")))
+    inline void convert_fixed_avx2(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples)
+      {
+      auto const sign = _mm256_set1_epi16(0x80);
+      auto output = reinterpret_cast<std::int16_t *>(samples);
+
+      std::size_t idx{};
+      for(; idx + 16 <= nofSamples; idx += 16)
+        {
+        for(std::size_t part = 0; part < 2; ++part)
+          {
+          auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx + 16 * part));
+          auto const words = _mm256_slli_epi16(_mm256_xor_si256(_mm256_cvtepu8_epi16(bytes), sign), 8);
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + 2 * idx + 16 * part), words);
+          }
+        }
+
+      convert_fixed_sse2(raw + 2 * idx, nofSamples - idx, samples + idx);
+      }
+#endif
+
+    /**
+     * @brief Check whether the kernel for the given instruction set can be used on the executing CPU
+     *
+     * @since 1.1.0
+     */
+    inline bool supported(isa const target)
+      {
+      switch(target)
+        {
+        case isa::scalar:
+          return true;
+#if defined(DABDEVICE_CONVERSION_X86)
+        case isa::sse2:
+          __builtin_cpu_init();
+          return __builtin_cpu_supports("sse2");
+        case isa::avx2:
+          __builtin_cpu_init();
+          return __builtin_cpu_supports("avx2");
+        case isa::avx512:
+          __builtin_cpu_init();
+          return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+          return false;
+        }
+      }
+
+    /**
+     * @brief Get the kernel for the given instruction set
+     *
+     * @note The caller is responsible for checking, that the instruction set is #supported on the executing
+     * CPU. If no kernel was built for the instruction set, the scalar kernel is returned.
+     *
+     * @since 1.1.0
+     */
+    inline kernel kernel_for(isa const target)
+      {
+      switch(target)
+        {
+#if defined(DABDEVICE_CONVERSION_X86)
+        case isa::sse2:
+          return &convert_sse2;
+        case isa::avx2:
+          return &convert_avx2;
+        case isa::avx512:
+          return &convert_avx512;
+#endif
+        default:
+          return &convert_scalar;
+        }
+      }
+
+    /**
+     * @brief Get the fixed-point kernel for the given instruction set
+     *
+     * Since 16-bit integer operations on 512-bit registers require AVX-512BW, the AVX2 kernel is used for
+     * dab::conversion::isa::avx512.
+     *
+     * @note The caller is responsible for checking, that the instruction set is #supported on the executing
+     * CPU. If no kernel was built for the instruction set, the scalar kernel is returned.
+     *
+     * @since 1.1.0
+     */
+    inline fixed_kernel fixed_kernel_for(isa const target)
+      {
+      switch(target)
+        {
+#if defined(DABDEVICE_CONVERSION_X86)
+        case isa::sse2:
+          return &convert_fixed_sse2;
+        case isa::avx2:
+        case isa::avx512:
+          return &convert_fixed_avx2;
+#endif
+        default:
+          return &convert_fixed_scalar;
+        }
+      }
+
+    /**
+     * @brief Get the most capable instruction set supported by the executing CPU
+     *
+     * The CPU is only queried once, the result is cached for the lifetime of the process.
+     *
+     * @since 1.1.0
+     */
+    inline isa best_isa()
+      {
+      static auto const best = []{
+        for(auto const candidate : {isa::avx512, isa::avx2, isa::sse2})
+          {
+          if(supported(candidate))
+            {
+            return candidate;
+            }
+          }
+        return isa::scalar;
+      }();
+
+      return best;
+      }
+
+    /**
+     * @brief Convert interleaved unsigned 8-bit I/Q pairs into normalized complex samples
+     *
+     * This function dispatches to the kernel for the #best_isa of the executing CPU.
+     *
+     * @param raw The first byte of the raw samples
+     * @param nofSamples The number of I/Q pairs to convert
+     * @param samples The destination for the converted samples. Must provide room for @p nofSamples samples.
+     *
+     * @since 1.1.0
+     */
+    inline void convert(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples)
+      {
+      static auto const selected = kernel_for(best_isa());
+      selected(raw, nofSamples, samples);
+      }
+
+    /**
+     * @brief Convert @p nofSamples interleaved raw I/Q pairs starting at @p raw into Q15 fixed-point samples
+     *
+     * This function dispatches to the fixed-point kernel for the #best_isa of the executing CPU.
+     *
+     * @since 1.1.0
+     */
+    inline void convert(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples)
+      {
+      static auto const selected = fixed_kernel_for(best_isa());
+      selected(raw, nofSamples, samples);
+      }
+
+    /**
+     * @brief Convert @p nofSamples raw samples into normalized complex samples
+     *
+     * This overload allows consumers of raw sample blocks to convert the samples themselves.
+     *
+     * @since 1.1.0
+     */
+    inline void convert(raw_sample const * raw, std::size_t nofSamples, dab::internal::sample_t * samples)
+      {
+      convert(reinterpret_cast<std::uint8_t const *>(raw), nofSamples, samples);
+      }
+
+    /**
+     * @brief The number of samples converted at once by #convert_chunked
+     *
+     * A chunk of this many normalized samples occupies 32 KiB, which fits into the L1 data cache of most
+     * current CPUs.
+     *
+     * @since 1.1.0
+     */
+    std::size_t constexpr kChunkSize = 4096;
+
+    /**
+     * @brief Lazily convert a block of raw samples, one cache-sized chunk at a time
+     *
+     * Instead of expanding the whole block up front, the samples are converted into a chunk of at most
+     * #kChunkSize samples, which is then passed to @p consume, while it is still hot in the cache.
+     *
+     * @param raw The first raw sample to convert
+     * @param nofSamples The number of raw samples to convert
+     * @param consume A callable accepting a pointer to the converted chunk and the number of samples in it
+     *
+     * @since 1.1.0
+     */
+    template<typename Consumer>
+    void convert_chunked(raw_sample const * raw, std::size_t nofSamples, Consumer && consume)
+      {
+      dab::internal::sample_t chunk[kChunkSize];
+      for(std::size_t offset = 0; offset < nofSamples; offset += kChunkSize)
+        {
+        auto const count = std::min(kChunkSize, nofSamples - offset);
+        convert(raw + offset, count, chunk);
+        consume(static_cast<dab::internal::sample_t const *>(chunk), count);
+        }
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_CONVERSION_LOOKUP_TABLE
+#define DABDEVICE_CONVERSION_LOOKUP_TABLE
+
+#include "dab/types/fixed_sample.h"
+#include "dab/types/frequency.h"
+#include "dab/types/gain.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace conversion
+    {
+
+    /**
+     * @brief Correction parameters applied while converting raw samples
+     *
+     * RTL-SDR based receivers exhibit a DC offset (the well known spike at the center frequency) as well as
+     * a slight gain mismatch between the in-phase and quadrature branches. Both depend on the tuner settings
+     * and can be compensated during conversion at no additional cost.
+     *
+     * @since 1.1.0
+     */
+    struct calibration
+      {
+      /**
+       * @brief Construct a calibration, which by default does not alter the samples
+       */
+      constexpr calibration(float inphase = 0.0f, float quadrature = 0.0f, float imbalance = 1.0f)
+        : inphaseOffset{inphase},
+          quadratureOffset{quadrature},
+          quadratureGain{imbalance}
+        {
+
+        }
+
+      /**
+       * @brief The DC offset of the normalized in-phase component, subtracted from every sample
+       */
+      float inphaseOffset;
+
+      /**
+       * @brief The DC offset of the normalized quadrature component, subtracted from every sample
+       */
+      float quadratureOffset;
+
+      /**
+       * @brief The factor applied to the offset-corrected quadrature component to match the in-phase gain
+       */
+      float quadratureGain;
+
+      /**
+       * @brief Compare two calibrations for equality
+       */
+      bool operator==(calibration const & rhs) const
+        {
+        return inphaseOffset == rhs.inphaseOffset &&
+               quadratureOffset == rhs.quadratureOffset &&
+               quadratureGain == rhs.quadratureGain;
+        }
+
+      /**
+       * @brief Compare two calibrations for inequality
+       */
+      bool operator!=(calibration const & rhs) const
+        {
+        return !(*this == rhs);
+        }
+      };
+
+    /**
+     * @brief A function providing the calibration for a given center frequency and gain
+     *
+     * @since 1.1.0
+     */
+    using calibration_source = std::function<calibration(frequency, gain)>;
+
+    /**
+     * @brief Create a calibration source that yields the same calibration for every tuner setting
+     *
+     * @since 1.1.0
+     */
+    inline calibration_source fixed(calibration const & calibration)
+      {
+      return [calibration](frequency, gain){ return calibration; };
+      }
+
+    /**
+     * @brief A conversion table mapping every raw (I,Q) byte pair to its corrected sample
+     *
+     * The table holds 65536 precomputed samples in both floating-point and Q15 fixed-point representation, so
+     * the conversion of a raw sample boils down to a single load. Building the table is comparatively expensive, it
+     * should thus only be done off the hot path.
+     *
+     * @since 1.1.0
+     */
+    struct lookup_table
+      {
+      /**
+       * @brief The number of entries in a lookup table
+       */
+      static std::size_t constexpr kSize = 65536;
+
+      /**
+       * @brief Build the table for the given calibration
+       *
+       * With the default calibration, the table produces results that are bit-identical to the ones
+       * produced by dab::conversion::convert. Fixed-point entries saturate at the limits of the Q15 range.
+       */
+      explicit lookup_table(conversion::calibration const & calibration) :
+        m_calibration{calibration},
+        m_table(kSize),
+        m_fixedTable(kSize)
+        {
+        for(auto inphase = 0; inphase < 256; ++inphase)
+          {
+          for(auto quadrature = 0; quadrature < 256; ++quadrature)
+            {
+            std::uint8_t const raw[] = {static_cast<std::uint8_t>(inphase), static_cast<std::uint8_t>(quadrature)};
+            float floating_real = raw[0];
+            float floating_imag = raw[1];
+            auto const real = (floating_real - 128) / 128 - calibration.inphaseOffset;
+            auto const imag = ((floating_imag - 128) / 128 - calibration.quadratureOffset) * calibration.quadratureGain;
+            m_table[index(raw)] = dab::internal::sample_t{real, imag};
+            m_fixedTable[index(raw)] = fixed_sample{quantize(real), quantize(imag)};
+            }
+          }
+        }
+
+      /**
+       * @brief Convert @p nofSamples interleaved raw I/Q pairs starting at @p raw into @p samples
+       */
+      void convert(std::uint8_t const * raw, std::size_t nofSamples, dab::internal::sample_t * samples) const
+        {
+        auto const table = m_table.data();
+        for(std::size_t idx = 0; idx < nofSamples; ++idx)
+          {
+          samples[idx] = table[index(raw + 2 * idx)];
+          }
+        }
+
+      /**
+       * @brief Convert @p nofSamples interleaved raw I/Q pairs starting at @p raw into Q15 fixed-point samples
+       */
+      void convert(std::uint8_t const * raw, std::size_t nofSamples, fixed_sample * samples) const
+        {
+        auto const table = m_fixedTable.data();
+        for(std::size_t idx = 0; idx < nofSamples; ++idx)
+          {
+          samples[idx] = table[index(raw + 2 * idx)];
+          }
+        }
+
+      /**
+       * @brief Get the corrected sample for the raw I/Q pair starting at @p raw
+       */
+      dab::internal::sample_t operator()(std::uint8_t const * raw) const
+        {
+        return m_table[index(raw)];
+        }
+
+      /**
+       * @brief Get the calibration this table was built for
+       */
+      conversion::calibration const & calibration() const
+        {
+        return m_calibration;
+        }
+
+      private:
+        /**
+         * @internal
+         *
+         * @brief Compute the table index of the raw I/Q pair starting at @p raw
+         *
+         * The pair is loaded as a single 16-bit word. Since the table is built using the same function, the
+         * mapping is independent of the endianness of the host.
+         */
+        static std::uint16_t index(std::uint8_t const * raw)
+          {
+          std::uint16_t index;
+          std::memcpy(&index, raw, sizeof(index));
+          return index;
+          }
+
+        /**
+         * @internal
+         *
+         * @brief Scale a normalized component to Q15, saturating at the limits of the representation
+         */
+        static std::int16_t quantize(float component)
+          {
+          auto const scaled = std::round(component * 32768.0f);
+          return static_cast<std::int16_t>(std::max(-32768.0f, std::min(32767.0f, scaled)));
+          }
+
+        conversion::calibration const m_calibration;
+        std::vector<dab::internal::sample_t> m_table;
+        std::vector<fixed_sample> m_fixedTable;
+      };
+
+    }
+
+  }
+
+#endif
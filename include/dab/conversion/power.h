@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_CONVERSION_POWER
+#define DABDEVICE_CONVERSION_POWER
+
+#include "dab/conversion/kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace conversion
+    {
+
+    /**
+     * @brief The signature of all kernels computing the energy of raw samples
+     *
+     * An energy kernel sums up (i - 128)^2 + (q - 128)^2 over @p nofSamples interleaved unsigned 8-bit I/Q pairs
+     * starting at @p raw. The pointer does not have to be aligned.
+     *
+     * @since 1.1.0
+     */
+    using energy_kernel = std::uint64_t (*)(std::uint8_t const * raw, std::size_t nofSamples);
+
+    /**
+     * @brief The scalar reference energy kernel
+     *
+     * Since the energy is computed with integer arithmetic, all other energy kernels produce identical results.
+     *
+     * @since 1.1.0
+     */
+    inline std::uint64_t energy_scalar(std::uint8_t const * raw, std::size_t nofSamples)
+      {
+      auto energy = std::uint64_t{};
+      for(std::size_t idx = 0; idx < 2 * nofSamples; ++idx)
+        {
+        auto const centered = static_cast<int>(raw[idx]) - 128;
+        energy += static_cast<std::uint64_t>(centered * centered);
+        }
+      return energy;
+      }
+
+#if defined(DABDEVICE_CONVERSION_X86)
+    /**
+     * @internal
+     *
+     * @brief The number of iterations after which the 32-bit lanes of the vectorized energy kernels are flushed
+     *
+     * Every iteration adds at most 2 * 2 * 128^2 = 65536 to a lane, so 16384 iterations stay well below 2^32.
+     */
+    std::size_t constexpr kEnergyFlushInterval = 16384;
+
+    /**
+     * @brief The SSE2 energy kernel, processing 8 samples per iteration
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("sse2")))
+    inline std::uint64_t energy_sse2(std::uint8_t const * raw, std::size_t nofSamples)
+      {
+      auto const zero = _mm_setzero_si128();
+      auto const offset = _mm_set1_epi16(128);
+      auto energy = std::uint64_t{};
+
+      std::size_t idx{};
+      while(idx + 8 <= nofSamples)
+        {
+        auto const end = idx + 8 * std::min(kEnergyFlushInterval, (nofSamples - idx) / 8);
+        auto sums = _mm_setzero_si128();
+
+        for(; idx < end; idx += 8)
+          {
+          auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx));
+          auto const low = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), offset);
+          auto const high = _mm_sub_epi16(_mm_unpackhi_epi8(bytes, zero), offset);
+          sums = _mm_add_epi32(sums, _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high)));
+          }
+
+        alignas(16) std::uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), sums);
+        energy += std::uint64_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3];
+        }
+
+      return energy + energy_scalar(raw + 2 * idx, nofSamples - idx);
+      }
+
+    /**
+     * @brief The AVX2 energy kernel, processing 16 samples per iteration
+     *
+     * @since 1.1.0
+     */
+    __attribute__((target("avx2")))
+    inline std::uint64_t energy_avx2(std::uint8_t const * raw, std::size_t nofSamples)
+      {
+      auto const offset = _mm256_set1_epi16(128);
+      auto energy = std::uint64_t{};
+
+      std::size_t idx{};
+      while(idx + 16 <= nofSamples)
+        {
+        auto const end = idx + 16 * std::min(kEnergyFlushInterval, (nofSamples - idx) / 16);
+        auto sums = _mm256_setzero_si256();
+
+        for(; idx < end; idx += 16)
+          {
+          auto const first = _mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx));
+          auto const second = _mm_loadu_si128(reinterpret_cast<__m128i const *>(raw + 2 * idx + 16));
+          auto const low = _mm256_sub_epi16(_mm256_cvtepu8_epi16(first), offset);
+          auto const high = _mm256_sub_epi16(_mm256_cvtepu8_epi16(second), offset);
+          sums = _mm256_add_epi32(sums, _mm256_add_epi32(_mm256_madd_epi16(low, low), _mm256_madd_epi16(high, high)));
+          }
+
+        alignas(32) std::uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sums);
+        for(auto const lane : lanes)
+          {
+          energy += lane;
+          }
+        }
+
+      return energy + energy_sse2(raw + 2 * idx, nofSamples - idx);
+      }
+#endif
+
+    /**
+     * @brief Get the energy kernel for the given instruction set
+     *
+     * Since 16-bit integer operations on 512-bit registers require AVX-512BW, the AVX2 kernel is used for
+     * dab::conversion::isa::avx512.
+     *
+     * @note The caller is responsible for checking, that the instruction set is #supported on the executing
+     * CPU. If no kernel was built for the instruction set, the scalar kernel is returned.
+     *
+     * @since 1.1.0
+     */
+    inline energy_kernel energy_kernel_for(isa const target)
+      {
+      switch(target)
+        {
+#if defined(DABDEVICE_CONVERSION_X86)
+        case isa::sse2:
+          return &energy_sse2;
+        case isa::avx2:
+        case isa::avx512:
+          return &energy_avx2;
+#endif
+        default:
+          return &energy_scalar;
+        }
+      }
+
+    /**
+     * @brief Compute the mean power of @p nofSamples interleaved raw I/Q pairs starting at @p raw
+     *
+     * The power is relative to the full scale of the normalized samples, so that a sample of (1.0, 0.0) has a
+     * power of 1. This function dispatches to the energy kernel for the #best_isa of the executing CPU.
+     *
+     * @return The mean power, or 0 if @p nofSamples is 0
+     *
+     * @since 1.1.0
+     */
+    inline double mean_power(std::uint8_t const * raw, std::size_t nofSamples)
+      {
+      static auto const selected = energy_kernel_for(best_isa());
+      return nofSamples ? static_cast<double>(selected(raw, nofSamples)) / (128.0 * 128.0) / nofSamples : 0.0;
+      }
+
+    }
+
+  }
+
+#endif
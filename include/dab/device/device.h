@@ -33,17 +33,24 @@
 #ifndef DABDEVICE__DEVICE
 #define DABDEVICE__DEVICE
 
+#include "dab/device/device_stats.h"
+#include "dab/device/thread_options.h"
+#include "dab/transport/sink.h"
 #include "dab/types/frequency.h"
 #include "dab/types/gain.h"
 
 #include <dab/types/common_types.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
 namespace dab
@@ -304,6 +311,37 @@ namespace dab
      */
     virtual void stop() { m_running.store(false); }
 
+    /**
+     * @brief Get the number of calls to #run that have entered sample
+     * acquisition so far
+     *
+     * Together with #wait_for_starts, this allows a thread that hands #run to
+     * another thread to wait until a subsequent #stop can no longer be
+     * overwritten by the starting acquisition.
+     *
+     * @since 1.1.0
+     */
+    std::uint64_t starts() const
+      {
+      std::lock_guard<std::mutex> lock{m_startMutex};
+      return m_starts;
+      }
+
+    /**
+     * @brief Wait until @p count calls to #run have entered sample
+     * acquisition
+     *
+     * A call to #run enters sample acquisition before doing anything else, so
+     * this function also returns if #run fails before acquiring any samples.
+     *
+     * @since 1.1.0
+     */
+    void wait_for_starts(std::uint64_t const count) const
+      {
+      auto lock = std::unique_lock<std::mutex>{m_startMutex};
+      m_started.wait(lock, [&]{ return m_starts >= count; });
+      }
+
     /**
      * @brief Enable a device option
      *
@@ -382,6 +420,126 @@ namespace dab
      */
     virtual bool disable(option const & option) = 0;
 
+    /**
+     * @brief Read up to @p count samples synchronously into @p samples
+     *
+     * Instead of acquiring samples on a dedicated thread and publishing them
+     * into the sink of the device, the samples are acquired on the calling
+     * thread and converted straight into the storage provided by the caller.
+     * This function blocks until @p count samples have been read or the end of
+     * the samples has been reached. It is meant for consumers that process
+     * samples in lock step with their acquisition, and must not be called while
+     * #run is acquiring samples.
+     *
+     * @tparam SampleType The type of the samples, which is one of
+     * dab::internal::sample_t, dab::raw_sample and dab::fixed_sample.
+     *
+     * @return The number of samples read, which is less than @p count only if
+     * the end of the samples has been reached, for example at the end of a
+     * recording that is not looped.
+     *
+     * @throws std::logic_error if the device does not support reading
+     * synchronously, or if it is running
+     *
+     * @since 1.1.0
+     */
+    template<typename SampleType>
+    std::size_t read(SampleType * samples, std::size_t const count)
+      {
+      if(running())
+        {
+        throw std::logic_error{"Samples cannot be read while the device is running."};
+        }
+
+      basic_buffer_sink<SampleType> target{samples, count};
+      pull(target, count);
+      return target.size();
+      }
+
+    /**
+     * @brief Select what happens to new samples when the sink of the device is
+     * full
+     *
+     * Each device selects a default that suits its source. Live devices, like
+     * dab::rtl_device, drop the samples that do not fit into their sink by
+     * default. The file devices default to dab::overflow_policy::block, which
+     * throttles the replay to the pace of the consumer, so that no sample of a
+     * recording is lost. For live devices, dab::overflow_policy::drop_oldest
+     * keeps the latency low when the consumer falls behind. Either way, the
+     * memory used for buffering is bounded by the capacity of the sink. The
+     * policy may be changed while samples are being acquired.
+     *
+     * Samples lost to an overflow are reported to the consumer: a
+     * dab::basic_block_pool marks the next block, while a dab::basic_spsc_ring
+     * reports the gap for the next read. Since a ring cannot discard samples
+     * its consumer has not read yet, dab::overflow_policy::drop_oldest drops
+     * the new samples instead.
+     *
+     * @note A dab::sample_queue_t grows without bounds, so no overflow ever
+     * happens for devices constructed from a queue. Use a dab::basic_block_pool
+     * or a dab::basic_spsc_ring to bound the memory instead.
+     *
+     * @since 1.1.0
+     */
+    void overflow(overflow_policy const policy)
+      {
+      m_overflow.store(policy, std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the current overflow policy of the device
+     *
+     * @since 1.1.0
+     */
+    overflow_policy overflow() const
+      {
+      return m_overflow.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Select the settings of the threads acquiring samples for the
+     * device
+     *
+     * The options are applied by #run, to every thread the device acquires
+     * samples on. Devices that spawn a dedicated acquisition thread, like
+     * dab::rtl_device, apply them to that thread. Devices that acquire their
+     * samples on the thread calling #run, like dab::rtl_file, apply them to the
+     * calling thread until #run returns. If an option cannot be applied, #run
+     * throws std::system_error before acquiring any samples. The options must
+     * not be changed while samples are being acquired.
+     *
+     * @since 1.1.0
+     */
+    void threading(thread_options options)
+      {
+      m_threading = std::move(options);
+      }
+
+    /**
+     * @brief Get the settings of the threads acquiring samples for the device
+     *
+     * @since 1.1.0
+     */
+    thread_options const & threading() const
+      {
+      return m_threading;
+      }
+
+    /**
+     * @brief Get a snapshot of the performance counters of the device
+     *
+     * This function never blocks and may be called from any thread, including
+     * while samples are being acquired. Devices that do not maintain the
+     * counters report a snapshot in which all counters are 0.
+     *
+     * @since 1.1.0
+     */
+    virtual device_stats stats() const
+      {
+      auto const bufferedBytes = m_output.buffered() * sample_size(m_output.format());
+      return m_counters.snapshot(bufferedBytes, m_output.observes_consumer());
+      }
+
     /**
      * @brief Get the descriptors for all available devices of the type
      */
@@ -396,8 +554,9 @@ namespace dab
        *
        * This constructor is only to be used by concrete device implementations.
        * It is used to initialiaze the common membmers of all devices, namely
-       * the sample output queue (#dab::device::m_samples) an the flag used to
-       * interrupt concurrent sample acquisition.
+       * the sample output (#dab::device::m_output) an the flag used to
+       * interrupt concurrent sample acquisition. The samples are published
+       * into the supplied queue, using a dab::queue_sink owned by the device.
        *
        * @par Example
        * @rst
@@ -414,18 +573,105 @@ namespace dab
        *
        * @since  1.0.0
        */
-      device(sample_queue_t & samples) : m_samples{samples} { }
+      device(sample_queue_t & samples) :
+        m_queueOutput{new queue_sink{samples}},
+        m_output{*m_queueOutput},
+        m_samples{samples}
+        {
+        }
+
+      /**
+       * @brief Construct a new device publishing its samples into the given
+       * sink
+       *
+       * This constructor is only to be used by concrete device implementations.
+       * The caller must guarantee that the sink outlives the device. Devices
+       * that do not support the #dab::sample_format of the sink should reject
+       * it by throwing std::invalid_argument.
+       *
+       * @since  1.1.0
+       */
+      device(sink & output) :
+        m_detachedSamples{new sample_queue_t{}},
+        m_output{output},
+        m_samples{*m_detachedSamples}
+        {
+        }
 
       /**
-       * @brief The sample output queue
+       * @brief Acquire up to @p count samples on the calling thread and deliver
+       * them into @p output
+       *
+       * This function is the extension point behind #read. Concrete
+       * implementations that support synchronous reading deliver samples into
+       * @p output, which has room for exactly @p count samples, until it is
+       * full or the end of the samples has been reached. The default
+       * implementation throws std::logic_error.
        *
-       * This queue is provided to all concrete implementations of #device. In
+       * @since 1.1.0
+       */
+      virtual void pull(sink & output, std::size_t const count)
+        {
+        static_cast<void>(output);
+        static_cast<void>(count);
+        throw std::logic_error{"The device does not support reading samples synchronously."};
+        }
+
+      /**
+       * @brief Keeps #m_running set while a call to #run acquires samples
+       *
+       * Concrete implementations create an acquisition at the very beginning
+       * of #run, before anything that may take a while or fail. It sets
+       * #m_running, so that a #stop issued afterwards is never overwritten,
+       * and reports the start to #wait_for_starts. #m_running is cleared again
+       * when the acquisition is destroyed, including when #run throws.
+       *
+       * @since 1.1.0
+       */
+      struct acquisition
+        {
+        explicit acquisition(device & owner) :
+          m_owner{owner}
+          {
+          m_owner.m_running.store(true, std::memory_order_release);
+
+          std::lock_guard<std::mutex> lock{m_owner.m_startMutex};
+          ++m_owner.m_starts;
+          m_owner.m_started.notify_all();
+          }
+
+        acquisition(acquisition const &) = delete;
+        acquisition & operator=(acquisition const &) = delete;
+
+        ~acquisition()
+          {
+          m_owner.m_running.store(false, std::memory_order_release);
+          }
+
+        private:
+          device & m_owner;
+        };
+
+    private:
+      std::unique_ptr<sink> m_queueOutput{};
+      std::unique_ptr<sample_queue_t> m_detachedSamples{};
+      mutable std::mutex m_startMutex{};
+      mutable std::condition_variable m_started{};
+      std::uint64_t m_starts{};
+
+    protected:
+      /**
+       * @brief The sample output
+       *
+       * This sink is provided to all concrete implementations of #device. In
        * order to publish the baseband samples acquired by a device
-       * implementation, the implementation must enqueue these samples into this
-       * queue.
+       * implementation, the implementation must reserve room in the sink,
+       * write the samples into it and then commit them.
        *
-       * The queue type is thread-safe, so no additional locking has to be used
-       * when enqueueing the samples. Samples are expected to be in I/Q format
+       * Sinks are used by a single producer, so no additional locking has to
+       * be used when publishing samples from the acquisition thread. The
+       * format of the samples is determined by the dab::sink::format of the
+       * sink. Complex floating-point samples are expected to be in I/Q format
        * and their component must be scaled to lie between -1.0f and 1.0f.
        *
        * @par Example
@@ -439,11 +685,26 @@ namespace dab
        *        void some_acquisition_callback(std::vector<sample_t> data) {
        *          // ensure scaling ...
        *          // possibly more processing ..
-       *          m_samples.enqueue(std::move(data));
+       *          static_cast<dab::sample_sink &>(m_output).write(data.data(), data.size());
        *        }
        *    };
        * @endrst
        *
+       * @since  1.1.0
+       */
+      sink & m_output;
+
+      /**
+       * @brief The sample output queue
+       *
+       * For devices constructed from a #dab::sample_queue_t, this is the queue
+       * passed to the constructor, and #m_output publishes into it. Devices
+       * constructed from a sink get a queue of their own that nobody consumes,
+       * so samples enqueued into it are lost.
+       *
+       * @deprecated Publish samples through #m_output instead, which works for
+       * every kind of output. This member will be removed in 1.2.0.
+       *
        * @since  1.0.0
        */
       sample_queue_t & m_samples;
@@ -459,6 +720,7 @@ namespace dab
        *
        * If the sample acquisition process is managed by a different facility,
        * the implementor must also implement #running and #stop accordingly.
+       * Implementations of #run set this flag through an #acquisition.
        * @par Example
        * @rst
        * .. code-block:: cpp
@@ -478,6 +740,60 @@ namespace dab
        * @since  1.0.0
        */
       std::atomic_bool m_running{};
+
+      /**
+       * @brief The performance counters reported by #stats
+       *
+       * Concrete implementations record every block they acquire from their
+       * acquisition thread. The counters are cheap enough to be updated for
+       * every block.
+       *
+       * @par Example
+       * @rst
+       * .. code-block:: cpp
+       *
+       *    #include <dab/device/device.h>
+       *
+       *    struct custom_device : dab::device {
+       *      private:
+       *        void some_acquisition_callback(std::vector<sample_t> data) {
+       *          auto const start = dab::device_counters::clock::now();
+       *          auto & output = static_cast<dab::sample_sink &>(m_output);
+       *          auto const delivered = output.write(data.data(), data.size());
+       *          auto const end = dab::device_counters::clock::now();
+       *          m_counters.record(data.size(), delivered, 0, end - start, end - start, output.buffered());
+       *        }
+       *    };
+       * @endrst
+       *
+       * @since 1.1.0
+       */
+      device_counters m_counters{};
+
+      /**
+       * @brief The policy applied when #m_output is full
+       *
+       * Concrete implementations may store a different default in their
+       * constructors. They pass it to dab::conversion::converter::deliver,
+       * together with #m_running, so that a producer blocked by a full sink
+       * gives up once #stop is called.
+       *
+       * @since 1.1.0
+       */
+      std::atomic<overflow_policy> m_overflow{overflow_policy::drop_newest};
+
+      /**
+       * @brief The settings concrete implementations apply to their acquisition
+       * threads
+       *
+       * Concrete implementations apply them to every thread they acquire
+       * samples on before acquiring the first sample, using
+       * dab::apply_to_current_thread for threads of their own and
+       * dab::scoped_thread_options for the thread calling #run.
+       *
+       * @since 1.1.0
+       */
+      thread_options m_threading{};
     };
 
   /**
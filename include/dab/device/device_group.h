@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE__DEVICE_GROUP
+#define DABDEVICE__DEVICE_GROUP
+
+#include "dab/device/device.h"
+#include "dab/device/device_stats.h"
+#include "dab/transport/sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A group of devices of the same type that are acquiring samples together
+   *
+   * Every device of the group publishes into its own transport, which is created by the factory passed to the
+   * constructor, and acquires its samples on its own thread. The devices are opened in parallel, since opening
+   * a device typically spends most of its time waiting for the hardware.
+   *
+   * @par Example
+   * @rst
+   * .. code-block:: cpp
+   *
+   *    #include <dab/device/device_group.h>
+   *    #include <dab/device/rtl_device.h>
+   *    #include <dab/transport/block_pool.h>
+   *
+   *    auto group = dab::device_group<dab::rtl_device, dab::sample_block_pool>{
+   *      dab::rtl_device::descriptors(),
+   *      [](dab::device::descriptor const &){
+   *        return std::unique_ptr<dab::sample_block_pool>{new dab::sample_block_pool{8, 128 * 1024}};
+   *      }
+   *    };
+   *
+   *    group.start();
+   * @endrst
+   *
+   * @tparam DeviceType The type of the devices, which must be constructible from a dab::sink and a device index
+   * @tparam TransportType The type of the transports the devices publish into, which must derive from dab::sink
+   *
+   * @since 1.1.0
+   */
+  template<typename DeviceType, typename TransportType>
+  struct device_group
+    {
+    /**
+     * @brief The type of the function that creates the transport of a device
+     */
+    using transport_factory = std::function<std::unique_ptr<TransportType>(device::descriptor const &)>;
+
+    /**
+     * @brief Open the devices described by @p descriptors in parallel
+     *
+     * The transport of each device is created by @p makeTransport before the device is opened. The device is
+     * opened with the ID of its descriptor as its index.
+     *
+     * @throws Any exception thrown while creating a transport or opening a device. The first such exception is
+     * rethrown once all devices have been opened or failed to open, and all successfully opened devices are
+     * closed again.
+     */
+    device_group(std::vector<device::descriptor> const & descriptors, transport_factory const & makeTransport) :
+      m_descriptors{descriptors}
+      {
+      auto opening = std::vector<std::future<void>>{};
+      m_members.resize(descriptors.size());
+
+      for(auto index = std::size_t{}; index < descriptors.size(); ++index)
+        {
+        opening.push_back(std::async(std::launch::async, [&, index]{
+          auto & member = m_members[index];
+          member.transport = makeTransport(descriptors[index]);
+          member.device.reset(new DeviceType{*member.transport, descriptors[index].id});
+        }));
+        }
+
+      auto error = std::exception_ptr{};
+      for(auto & open : opening)
+        {
+        try
+          {
+          open.get();
+          }
+        catch(...)
+          {
+          if(!error)
+            {
+            error = std::current_exception();
+            }
+          }
+        }
+
+      if(error)
+        {
+        std::rethrow_exception(error);
+        }
+      }
+
+    device_group(device_group const &) = delete;
+    device_group & operator=(device_group const &) = delete;
+
+    /**
+     * @brief Stop all devices and close them
+     *
+     * Errors reported by the devices while stopping are ignored. Call #stop beforehand to observe them.
+     */
+    ~device_group()
+      {
+      try
+        {
+        stop();
+        }
+      catch(...)
+        {
+        }
+      }
+
+    /**
+     * @brief Start sample acquisition on all devices
+     *
+     * Every device runs on its own thread. Devices that are already running are left untouched. This function
+     * returns once every device has entered sample acquisition, so that a subsequent #stop is never overwritten
+     * by a device that is still starting up.
+     */
+    void start()
+      {
+      for(auto & member : m_members)
+        {
+        if(!member.runner.valid())
+          {
+          auto & device = *member.device;
+          member.starts = device.starts() + 1;
+          member.runner = std::async(std::launch::async, [&device]{ device.run(); });
+          }
+        }
+
+      for(auto & member : m_members)
+        {
+        member.device->wait_for_starts(member.starts);
+        }
+      }
+
+    /**
+     * @brief Stop sample acquisition on all devices and wait for their threads to finish
+     *
+     * All devices are asked to stop before waiting for any of them, so that they stop at about the same time.
+     *
+     * @throws Any exception thrown by the acquisition of one of the devices, for example because it was
+     * unplugged. The first such exception is rethrown after all devices have stopped.
+     */
+    void stop()
+      {
+      for(auto & member : m_members)
+        {
+        member.device->stop();
+        }
+
+      auto error = std::exception_ptr{};
+      for(auto & member : m_members)
+        {
+        if(member.runner.valid())
+          {
+          try
+            {
+            member.runner.get();
+            }
+          catch(...)
+            {
+            if(!error)
+              {
+              error = std::current_exception();
+              }
+            }
+          }
+        }
+
+      if(error)
+        {
+        std::rethrow_exception(error);
+        }
+      }
+
+    /**
+     * @brief Get the number of devices in the group
+     */
+    std::size_t size() const
+      {
+      return m_members.size();
+      }
+
+    /**
+     * @brief Get the device at @p index
+     */
+    DeviceType & operator[](std::size_t const index)
+      {
+      return *m_members[index].device;
+      }
+
+    /**
+     * @brief Get the descriptor the device at @p index was opened from
+     */
+    device::descriptor const & descriptor(std::size_t const index) const
+      {
+      return m_descriptors[index];
+      }
+
+    /**
+     * @brief Get the transport the device at @p index publishes into
+     */
+    TransportType & transport(std::size_t const index)
+      {
+      return *m_members[index].transport;
+      }
+
+    /**
+     * @brief Get a snapshot of the performance counters of the device at @p index
+     */
+    device_stats stats(std::size_t const index) const
+      {
+      return m_members[index].device->stats();
+      }
+
+    /**
+     * @brief Get a snapshot of the combined performance counters of all devices
+     *
+     * @see dab::aggregate
+     */
+    device_stats stats() const
+      {
+      auto all = std::vector<device_stats>{};
+      all.reserve(m_members.size());
+
+      for(auto const & member : m_members)
+        {
+        all.push_back(member.device->stats());
+        }
+
+      return aggregate(all);
+      }
+
+    private:
+      struct member
+        {
+        std::unique_ptr<TransportType> transport{};
+        std::unique_ptr<DeviceType> device{};
+        std::future<void> runner{};
+        std::uint64_t starts{};
+        };
+
+      std::vector<device::descriptor> const m_descriptors;
+      std::vector<member> m_members{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_DEVICE_DEVICE_STATS
+#define DABDEVICE_DEVICE_DEVICE_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A snapshot of the performance counters of a device
+   *
+   * @see dab::device::stats
+   * @since 1.1.0
+   */
+  struct device_stats
+    {
+    /**
+     * @brief The number of samples delivered into the sink of the device
+     */
+    std::uint64_t samples;
+
+    /**
+     * @brief The number of blocks of which at least one sample was delivered into the sink
+     */
+    std::uint64_t blocks;
+
+    /**
+     * @brief The number of blocks the device acquired, e.g. the number of USB transfers of a stick
+     */
+    std::uint64_t callbacks;
+
+    /**
+     * @brief The shortest time it took to handle a block
+     */
+    std::chrono::nanoseconds minCallback;
+
+    /**
+     * @brief The average time it took to handle a block
+     */
+    std::chrono::nanoseconds avgCallback;
+
+    /**
+     * @brief The longest time it took to handle a block
+     */
+    std::chrono::nanoseconds maxCallback;
+
+    /**
+     * @brief The total time spent converting samples into the sink
+     */
+    std::chrono::nanoseconds conversionTime;
+
+    /**
+     * @brief The largest number of samples buffered in the sink after a block was delivered
+     *
+     * This is 0 for sinks that cannot determine how much they buffer (see #bufferingKnown).
+     */
+    std::size_t highWaterMark;
+
+    /**
+     * @brief The number of blocks during whose delivery samples were dropped
+     */
+    std::uint64_t droppedBlocks;
+
+    /**
+     * @brief The number of samples that were dropped, either because they did not fit into the sink or because
+     * they were discarded from it to make room for newer ones
+     */
+    std::uint64_t droppedSamples;
+
+    /**
+     * @brief The number of bytes currently buffered in the sink
+     *
+     * This is 0 for sinks that cannot determine how much they buffer (see #bufferingKnown).
+     */
+    std::size_t bufferedBytes;
+
+    /**
+     * @brief The time since the last sample was delivered
+     *
+     * If no sample has been delivered yet, this is the time since the device was created.
+     */
+    std::chrono::nanoseconds idle;
+
+    /**
+     * @brief Whether #highWaterMark and #bufferedBytes reflect the sink of the device
+     *
+     * This is @c false for sinks that cannot observe their consumer (see dab::sink::observes_consumer), like the
+     * dab::queue_sink used by devices constructed from a dab::sample_queue_t.
+     */
+    bool bufferingKnown;
+    };
+
+  /**
+   * @brief Combine the performance counters of several devices into one snapshot
+   *
+   * Counts, times and buffered bytes are summed up. The callback times are combined over all callbacks of all
+   * devices, while the high water mark and the idle time are those of the device that reached the highest mark
+   * and the one that has been idle the longest respectively. The buffering is only known if it is known for every
+   * device.
+   *
+   * @since 1.1.0
+   */
+  inline device_stats aggregate(std::vector<device_stats> const & stats)
+    {
+    auto result = device_stats{};
+    auto totalCallback = std::chrono::nanoseconds{};
+    result.bufferingKnown = !stats.empty();
+
+    for(auto const & single : stats)
+      {
+      if(single.callbacks)
+        {
+        result.minCallback = result.callbacks ? std::min(result.minCallback, single.minCallback) : single.minCallback;
+        }
+
+      result.samples += single.samples;
+      result.blocks += single.blocks;
+      result.callbacks += single.callbacks;
+      totalCallback += single.avgCallback * static_cast<std::int64_t>(single.callbacks);
+      result.maxCallback = std::max(result.maxCallback, single.maxCallback);
+      result.conversionTime += single.conversionTime;
+      result.highWaterMark = std::max(result.highWaterMark, single.highWaterMark);
+      result.droppedBlocks += single.droppedBlocks;
+      result.droppedSamples += single.droppedSamples;
+      result.bufferedBytes += single.bufferedBytes;
+      result.idle = std::max(result.idle, single.idle);
+      result.bufferingKnown = result.bufferingKnown && single.bufferingKnown;
+      }
+
+    if(result.callbacks)
+      {
+      result.avgCallback = totalCallback / static_cast<std::int64_t>(result.callbacks);
+      }
+
+    return result;
+    }
+
+  /**
+   * @brief The performance counters maintained by a device
+   *
+   * The counters are written by the acquisition thread only. Since there is a single writer, they are updated
+   * with relaxed loads and stores instead of read-modify-write operations, which keeps the cost per block at a
+   * few plain memory accesses. A #snapshot can be taken from any thread without locking. The fields of a
+   * snapshot are not guaranteed to be updated atomically as a whole, but every field is accurate by itself.
+   *
+   * @since 1.1.0
+   */
+  struct device_counters
+    {
+    using clock = std::chrono::steady_clock;
+
+    device_counters()
+      : m_lastSample{clock::now().time_since_epoch().count()}
+      {
+
+      }
+
+    device_counters(device_counters const &) = delete;
+    device_counters & operator=(device_counters const &) = delete;
+
+    /**
+     * @brief Account for a block that was handled by the acquisition thread
+     *
+     * @param offered The number of samples in the block
+     * @param delivered The number of samples that were accepted by the sink
+     * @param discarded The number of buffered samples that were discarded from the sink to make room
+     * @param callback The time it took to handle the block
+     * @param conversion The time spent converting the block into the sink
+     * @param buffered The number of samples buffered in the sink after the block was delivered
+     */
+    void record(std::size_t const offered, std::size_t const delivered, std::size_t const discarded,
+                clock::duration const callback, clock::duration const conversion, std::size_t const buffered)
+      {
+      auto const duration = std::chrono::duration_cast<std::chrono::nanoseconds>(callback).count();
+
+      bump(m_callbacks, 1);
+      bump(m_totalCallback, duration);
+      bump(m_conversionTime, std::chrono::duration_cast<std::chrono::nanoseconds>(conversion).count());
+
+      if(duration < m_minCallback.load(std::memory_order_relaxed))
+        {
+        m_minCallback.store(duration, std::memory_order_relaxed);
+        }
+
+      if(duration > m_maxCallback.load(std::memory_order_relaxed))
+        {
+        m_maxCallback.store(duration, std::memory_order_relaxed);
+        }
+
+      if(buffered > m_highWaterMark.load(std::memory_order_relaxed))
+        {
+        m_highWaterMark.store(buffered, std::memory_order_relaxed);
+        }
+
+      if(delivered)
+        {
+        bump(m_samples, delivered);
+        bump(m_blocks, 1);
+        m_lastSample.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+      if(delivered < offered || discarded)
+        {
+        bump(m_droppedBlocks, 1);
+        bump(m_droppedSamples, offered - delivered + discarded);
+        }
+      }
+
+    /**
+     * @brief Take a snapshot of the counters
+     *
+     * @param bufferedBytes The number of bytes currently buffered in the sink of the device
+     * @param bufferingKnown Whether the sink of the device knows how much it buffers
+     */
+    device_stats snapshot(std::size_t const bufferedBytes, bool const bufferingKnown) const
+      {
+      auto const callbacks = m_callbacks.load(std::memory_order_relaxed);
+      auto const minCallback = m_minCallback.load(std::memory_order_relaxed);
+      auto const lastSample = clock::time_point{clock::duration{m_lastSample.load(std::memory_order_relaxed)}};
+
+      return {
+        m_samples.load(std::memory_order_relaxed),
+        m_blocks.load(std::memory_order_relaxed),
+        callbacks,
+        std::chrono::nanoseconds{callbacks ? minCallback : 0},
+        std::chrono::nanoseconds{callbacks ? m_totalCallback.load(std::memory_order_relaxed) / callbacks : 0},
+        std::chrono::nanoseconds{m_maxCallback.load(std::memory_order_relaxed)},
+        std::chrono::nanoseconds{m_conversionTime.load(std::memory_order_relaxed)},
+        m_highWaterMark.load(std::memory_order_relaxed),
+        m_droppedBlocks.load(std::memory_order_relaxed),
+        m_droppedSamples.load(std::memory_order_relaxed),
+        bufferedBytes,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - lastSample),
+        bufferingKnown,
+      };
+      }
+
+    private:
+      template<typename ValueType, typename AmountType>
+      static void bump(std::atomic<ValueType> & counter, AmountType const amount)
+        {
+        counter.store(counter.load(std::memory_order_relaxed) + static_cast<ValueType>(amount), std::memory_order_relaxed);
+        }
+
+      std::atomic<std::uint64_t> m_samples{};
+      std::atomic<std::uint64_t> m_blocks{};
+      std::atomic<std::uint64_t> m_callbacks{};
+      std::atomic<std::int64_t> m_minCallback{std::numeric_limits<std::int64_t>::max()};
+      std::atomic<std::int64_t> m_maxCallback{};
+      std::atomic<std::int64_t> m_totalCallback{};
+      std::atomic<std::int64_t> m_conversionTime{};
+      std::atomic<std::size_t> m_highWaterMark{};
+      std::atomic<std::uint64_t> m_droppedBlocks{};
+      std::atomic<std::uint64_t> m_droppedSamples{};
+      std::atomic<clock::rep> m_lastSample;
+    };
+
+  }
+
+#endif
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE__FILE_DEVICE
+#define DABDEVICE__FILE_DEVICE
+
+#include "dab/conversion/converter.h"
+#include "dab/device/device.h"
+#include "dab/device/pacer.h"
+#include "dab/types/gain.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The common base of the devices replaying IQ-sample dumps acquired from RTLSDR USB sticks
+   *
+   * A file device replays a recording in blocks of a fixed number of bytes, which are converted in one pass
+   * and published as a whole. It accepts any center frequency and gain, since these only affect the
+   * calibration applied while converting, and replays the recording in a loop while dab::device::option::loop
+   * is enabled. Concrete implementations only provide access to the bytes of the recording.
+   *
+   * Unlike live devices, a file device waits for the consumer when its sink is full, so that no samples of the
+   * recording are lost (see dab::device::overflow).
+   *
+   * @since 1.1.0
+   */
+  struct file_device : device
+    {
+    /**
+     * @brief The default number of bytes converted and published in one go
+     *
+     * @since 1.1.0
+     */
+    static std::size_t constexpr kDefaultBlockSize = 256 * 1024;
+
+    bool tune(frequency centerFrequency) override
+      {
+      m_converter.update(centerFrequency);
+      return true;
+      }
+
+    bool gain(dab::gain gain) override
+      {
+      m_converter.update(gain);
+      return true;
+      }
+
+    dab::gain gain() const override
+      {
+      using namespace dab::literals;
+      return 0.0_dB;
+      }
+
+    std::vector<dab::gain> gains() const override
+      {
+      return {};
+      }
+
+    /**
+     * @brief Correct DC offset and I/Q imbalance while converting samples
+     *
+     * Once a calibration source has been installed, samples are converted through a lookup table built from
+     * the calibration for the current center frequency and gain. The table is rebuilt by #tune and #gain
+     * whenever the calibration changes. Installing an empty source restores the uncorrected conversion.
+     *
+     * @since 1.1.0
+     */
+    void calibrate(conversion::calibration_source source)
+      {
+      m_converter.calibrate(std::move(source));
+      }
+
+    /**
+     * @brief Release samples at @p speed times the rate of a real receiver
+     *
+     * By default, samples are released as fast as they can be read, which corresponds to a speed of
+     * dab::pacer::kUnthrottled. Pacing allows replaying a recording with the timing of real hardware.
+     *
+     * @since 1.1.0
+     */
+    void pace(double const speed)
+      {
+      m_pacer.speed(speed);
+      }
+
+    /**
+     * @brief Get the pacer of this device, which reports how far the replay falls behind schedule
+     *
+     * @since 1.1.0
+     */
+    dab::pacer const & pacing() const
+      {
+      return m_pacer;
+      }
+
+    /**
+     * @brief Replay the recording on the calling thread
+     *
+     * The thread options of the device are applied to the calling thread before the first sample is read, and
+     * the previous settings of the thread are restored when this function returns.
+     *
+     * @throws std::system_error if the thread options cannot be applied
+     */
+    void run() override
+      {
+      acquisition const acquiring{*this};
+      scoped_thread_options const threading{m_threading};
+
+      while(m_running)
+        {
+        if(exhausted())
+          {
+          if(m_doLoop)
+            {
+            rewind();
+            }
+          else
+            {
+            stop();
+            }
+
+          continue;
+          }
+
+        auto const start = device_counters::clock::now();
+        auto nofSamples = std::size_t{};
+        auto const raw = next_block(m_blockSize, nofSamples);
+        auto const read = device_counters::clock::now();
+
+        if(nofSamples)
+          {
+          m_pacer.release(nofSamples);
+          auto const converting = device_counters::clock::now();
+          m_converter.announce(m_output, nofSamples, converting);
+          auto const policy = m_overflow.load(std::memory_order_relaxed);
+          auto const result = m_converter.deliver(m_output, raw, nofSamples, policy, &m_running);
+          auto const end = device_counters::clock::now();
+
+          // The time spent waiting for the pacer is not part of handling the block
+          m_counters.record(nofSamples, result.delivered, result.discarded, (read - start) + (end - converting),
+                            end - converting, m_output.buffered());
+          }
+        }
+      }
+
+    bool enable(option const & option) override
+      {
+      if(option == option::loop)
+        {
+        m_doLoop = true;
+        return true;
+        }
+
+      return false;
+      }
+
+    bool disable(option const & option) override
+      {
+      if(option == option::loop)
+        {
+        m_doLoop = false;
+        return true;
+        }
+
+      return false;
+      }
+
+    protected:
+      /**
+       * @brief Construct a file device publishing into the given sample queue
+       *
+       * @throws std::invalid_argument if @p blockSize is zero or not a multiple of 2
+       */
+      file_device(sample_queue_t & samples, std::size_t const blockSize) :
+        device{samples},
+        m_blockSize{checked(blockSize)}
+        {
+        overflow(overflow_policy::block);
+        }
+
+      /**
+       * @brief Construct a file device publishing into the given sink
+       *
+       * @throws std::invalid_argument if @p blockSize is zero or not a multiple of 2, or if the format of
+       * @p output is not supported
+       */
+      file_device(sink & output, std::size_t const blockSize) :
+        device{conversion::converter::check(output)},
+        m_blockSize{checked(blockSize)}
+        {
+        overflow(overflow_policy::block);
+        }
+
+      /**
+       * @brief Read the next samples of the recording on the calling thread
+       *
+       * The recording is read in blocks of at most the block size of the device, until @p count samples have
+       * been delivered or the end of the recording has been reached while looping is disabled.
+       */
+      void pull(sink & output, std::size_t const count) override
+        {
+        for(auto remaining = count; remaining;)
+          {
+          if(exhausted())
+            {
+            if(!m_doLoop)
+              {
+              break;
+              }
+
+            rewind();
+            continue;
+            }
+
+          auto const start = device_counters::clock::now();
+          auto nofSamples = std::size_t{};
+          auto const raw = next_block(std::min(remaining * 2, m_blockSize), nofSamples);
+          auto const read = device_counters::clock::now();
+
+          if(nofSamples)
+            {
+            m_pacer.release(nofSamples);
+            auto const converting = device_counters::clock::now();
+            auto const result = m_converter.deliver(output, raw, nofSamples);
+            auto const end = device_counters::clock::now();
+
+            m_counters.record(nofSamples, result.delivered, result.discarded, (read - start) + (end - converting),
+                              end - converting, 0);
+            remaining -= result.delivered;
+            }
+          }
+        }
+
+      /**
+       * @brief Check whether the end of the recording has been reached
+       */
+      virtual bool exhausted() const = 0;
+
+      /**
+       * @brief Continue the replay at the start of the recording
+       */
+      virtual void rewind() = 0;
+
+      /**
+       * @brief Get the next block of at most @p length bytes of the recording
+       *
+       * A trailing odd byte at the end of the recording is not part of a complete sample and thus discarded.
+       *
+       * @param length The maximum number of bytes to read, which is a multiple of 2
+       * @param nofSamples Receives the number of complete samples in the block
+       * @return The raw bytes of the block, which stay valid until the next call
+       */
+      virtual std::uint8_t const * next_block(std::size_t const length, std::size_t & nofSamples) = 0;
+
+      /**
+       * @brief The maximum number of bytes converted and published in one go
+       */
+      std::size_t const m_blockSize;
+
+    private:
+      static std::size_t checked(std::size_t const blockSize)
+        {
+        if(!blockSize || blockSize % 2)
+          {
+          throw std::invalid_argument{"The block size must be a non-zero multiple of 2."};
+          }
+
+        return blockSize;
+        }
+
+      bool m_doLoop{};
+      conversion::converter m_converter{};
+      dab::pacer m_pacer{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE__HOP_SCHEDULE
+#define DABDEVICE__HOP_SCHEDULE
+
+#include "dab/types/channel.h"
+#include "dab/types/frequency.h"
+
+#include <dab/constants/sample_rate.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A single stop of a dab::hop_schedule
+   *
+   * @since 1.1.0
+   */
+  struct hop
+    {
+    /**
+     * @brief The channel to tune to
+     */
+    dab::channel channel;
+
+    /**
+     * @brief The time to spend acquiring samples on the channel, not counting the settling time
+     */
+    std::chrono::milliseconds dwell;
+    };
+
+  /**
+   * @brief A rotation of channels a single device monitors by dwelling on each of them in turn
+   *
+   * After tuning to the channel of a hop, the device discards the samples acquired during the settling time of
+   * the schedule, since they still carry transients of the tuner PLL. It then delivers exactly the number of
+   * samples corresponding to the dwell time of the hop, before moving on to the next hop. After the last hop,
+   * the rotation starts over. A hop on the same channel as the hop before it continues without retuning and
+   * settling, so the samples of both hops are contiguous. The samples discarded around a retune are reported
+   * to the sink as a discontinuity.
+   *
+   * @see dab::rtl_device::hopping
+   *
+   * @since 1.1.0
+   */
+  struct hop_schedule
+    {
+    /**
+     * @brief Get the default settling time after retuning
+     */
+    static constexpr std::chrono::milliseconds default_settle()
+      {
+      return std::chrono::milliseconds{5};
+      }
+
+    /**
+     * @brief Construct a schedule visiting @p hops in order
+     *
+     * @throws std::invalid_argument if @p hops is empty or one of the hops has no dwell time
+     */
+    explicit hop_schedule(std::vector<hop> hops, std::chrono::milliseconds const settle = default_settle())
+      : m_hops{std::move(hops)},
+        m_settle{settle}
+      {
+      if(m_hops.empty())
+        {
+        throw std::invalid_argument{"A hop schedule requires at least one hop."};
+        }
+
+      for(auto const & hop : m_hops)
+        {
+        if(hop.dwell <= std::chrono::milliseconds::zero())
+          {
+          throw std::invalid_argument{std::string{"The dwell time on channel "} + hop.channel.label + " must be positive."};
+          }
+        }
+
+      if(m_settle < std::chrono::milliseconds::zero())
+        {
+        throw std::invalid_argument{"The settling time must not be negative."};
+        }
+      }
+
+    /**
+     * @brief Get the number of hops in one rotation
+     */
+    std::size_t size() const
+      {
+      return m_hops.size();
+      }
+
+    /**
+     * @brief Get the hop at @p index
+     */
+    hop const & operator[](std::size_t const index) const
+      {
+      return m_hops[index];
+      }
+
+    /**
+     * @brief Get the settling time after retuning
+     */
+    std::chrono::milliseconds settle() const
+      {
+      return m_settle;
+      }
+
+    /**
+     * @brief Get the number of samples delivered on the hop at @p index
+     */
+    std::size_t dwell_samples(std::size_t const index, std::uint32_t const sampleRate = dab::kDefaultSampleRate) const
+      {
+      return samples(m_hops[index].dwell, sampleRate);
+      }
+
+    /**
+     * @brief Get the number of samples discarded after retuning
+     */
+    std::size_t settle_samples(std::uint32_t const sampleRate = dab::kDefaultSampleRate) const
+      {
+      return samples(m_settle, sampleRate);
+      }
+
+    /**
+     * @brief Get the time one rotation through all hops takes, including the settling times
+     *
+     * This is the longest time a channel goes unobserved, plus its own dwell time. Hops that continue on the
+     * channel of the hop before them do not settle, so the actual rotation may be shorter.
+     */
+    std::chrono::milliseconds period() const
+      {
+      auto total = m_settle * static_cast<std::chrono::milliseconds::rep>(m_hops.size());
+      for(auto const & hop : m_hops)
+        {
+        total += hop.dwell;
+        }
+      return total;
+      }
+
+    /**
+     * @brief Get the index of the first hop on the channel with center frequency @p centerFrequency
+     *
+     * This allows consumers to attribute the blocks delivered by a hopping device to the channel they belong to.
+     *
+     * @return The index of the hop, or #size if no hop tunes to @p centerFrequency
+     */
+    std::size_t index_of(frequency const centerFrequency) const
+      {
+      auto index = std::size_t{};
+      while(index < m_hops.size() && std::uint32_t(m_hops[index].channel.freq) != std::uint32_t(centerFrequency))
+        {
+        ++index;
+        }
+      return index;
+      }
+
+    private:
+      static std::size_t samples(std::chrono::milliseconds const duration, std::uint32_t const sampleRate)
+        {
+        return static_cast<std::size_t>(duration.count()) * sampleRate / 1000;
+        }
+
+      std::vector<hop> m_hops;
+      std::chrono::milliseconds m_settle;
+    };
+
+  }
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_DEVICE_PACER
+#define DABDEVICE_DEVICE_PACER
+
+#include <dab/constants/sample_rate.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace dab
+  {
+
+  /**
+   * @brief Release sample blocks at the rate of real hardware
+   *
+   * File based devices can produce samples much faster than a real receiver. A pacer throttles them by
+   * computing an absolute deadline for every block from the number of samples released so far, and sleeping
+   * until that deadline. Since the deadlines do not depend on how long a previous sleep actually took, the
+   * schedule does not drift. If the producer falls behind, blocks are released immediately until it has
+   * caught up, and the delay is reported via #lag and #max_lag.
+   *
+   * @since 1.1.0
+   */
+  struct pacer
+    {
+    /**
+     * @brief The speed at which samples are released as fast as possible
+     */
+    static double constexpr kUnthrottled = 0.0;
+
+    /**
+     * @brief Construct a pacer for the given sample rate, initially unthrottled
+     */
+    explicit pacer(std::uint32_t const sampleRate = dab::kDefaultSampleRate)
+      : m_sampleRate{sampleRate}
+      {
+
+      }
+
+    /**
+     * @brief Set the speed relative to real time
+     *
+     * A speed of 1.0 releases samples at the sample rate, a speed of 10.0 releases them ten times as fast.
+     * Speeds of dab::pacer::kUnthrottled or less disable pacing. Changing the speed starts a new schedule at
+     * the next released block.
+     */
+    void speed(double const speed)
+      {
+      m_speed.store(std::max(speed, double{kUnthrottled}), std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the speed relative to real time
+     */
+    double speed() const
+      {
+      return m_speed.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Wait for the deadline of the next block of @p nofSamples samples
+     */
+    void release(std::size_t const nofSamples)
+      {
+      auto const speed = m_speed.load(std::memory_order_relaxed);
+      if(speed <= kUnthrottled)
+        {
+        m_scheduled = false;
+        return;
+        }
+
+      auto const now = clock::now();
+      if(!m_scheduled || speed != m_scheduledSpeed)
+        {
+        m_epoch = now;
+        m_released = 0;
+        m_scheduled = true;
+        m_scheduledSpeed = speed;
+        }
+
+      auto const offset = std::chrono::duration<double>(m_released / (double(m_sampleRate) * speed));
+      auto const deadline = m_epoch + std::chrono::duration_cast<clock::duration>(offset);
+
+      if(now < deadline)
+        {
+        std::this_thread::sleep_until(deadline);
+        m_lag.store(0, std::memory_order_relaxed);
+        }
+      else
+        {
+        auto const lag = std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count();
+        m_lag.store(lag, std::memory_order_relaxed);
+        if(lag > m_maxLag.load(std::memory_order_relaxed))
+          {
+          m_maxLag.store(lag, std::memory_order_relaxed);
+          }
+        }
+
+      m_released += nofSamples;
+      }
+
+    /**
+     * @brief Get how far behind schedule the last block was released
+     */
+    std::chrono::nanoseconds lag() const
+      {
+      return std::chrono::nanoseconds{m_lag.load(std::memory_order_relaxed)};
+      }
+
+    /**
+     * @brief Get how far behind schedule any block has been released so far
+     */
+    std::chrono::nanoseconds max_lag() const
+      {
+      return std::chrono::nanoseconds{m_maxLag.load(std::memory_order_relaxed)};
+      }
+
+    private:
+      using clock = std::chrono::steady_clock;
+
+      std::uint32_t const m_sampleRate;
+      std::atomic<double> m_speed{kUnthrottled};
+      std::atomic<std::int64_t> m_lag{};
+      std::atomic<std::int64_t> m_maxLag{};
+      clock::time_point m_epoch{};
+      std::uint64_t m_released{};
+      double m_scheduledSpeed{};
+      bool m_scheduled{};
+    };
+
+  }
+
+#endif
@@ -33,15 +33,27 @@
 #define DABDEVICE_RTL_DEVICE
 
 #include "dab/constants/sample_rate.h"
+#include "dab/conversion/converter.h"
 #include "dab/device/device.h"
+#include "dab/device/hop_schedule.h"
+#include "dab/transport/raw_recorder.h"
 #include "dab/types/gain.h"
 
 #include <rtl-sdr.h>
 
+#include <algorithm>
 #include <array>
-#include <cmath>
-#include <future>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace dab
@@ -85,6 +97,102 @@ namespace dab
     extern "C" void callback(unsigned char * buffer, uint32_t length, void * context);
     }
 
+  /**
+   * @brief The USB transfers librtlsdr uses to acquire samples
+   *
+   * librtlsdr keeps #count transfers of #length bytes in flight and invokes the acquisition callback once per
+   * completed transfer. Short transfers reduce the time a sample waits before it is delivered, at the cost of
+   * more callbacks and thus more CPU time per sample. A count or length of 0 selects the default of librtlsdr,
+   * which is #kDefaultCount transfers of #kDefaultLength bytes.
+   *
+   * @since 1.1.0
+   */
+  struct rtl_transfers
+    {
+    /**
+     * @brief The number of transfers librtlsdr uses by default
+     */
+    static std::uint32_t constexpr kDefaultCount = 15;
+
+    /**
+     * @brief The length of a transfer librtlsdr uses by default
+     */
+    static std::uint32_t constexpr kDefaultLength = 16 * 32 * 512;
+
+    /**
+     * @brief The length of every transfer must be a multiple of this number of bytes
+     */
+    static std::uint32_t constexpr kLengthGranularity = 512;
+
+    /**
+     * @brief Few short transfers, delivering samples every 4 ms with at most 16 ms of buffering
+     */
+    static rtl_transfers low_latency()
+      {
+      return {4, 16 * 1024};
+      }
+
+    /**
+     * @brief The transfers librtlsdr uses by default, delivering samples every 64 ms
+     */
+    static rtl_transfers balanced()
+      {
+      return {};
+      }
+
+    /**
+     * @brief Many long transfers, delivering samples every 128 ms with about 4 s of buffering
+     */
+    static rtl_transfers high_throughput()
+      {
+      return {32, 512 * 1024};
+      }
+
+    /**
+     * @brief Construct a set of @p count transfers of @p length bytes each
+     */
+    constexpr rtl_transfers(std::uint32_t const count = 0, std::uint32_t const length = 0) :
+      count{count},
+      length{length}
+      {
+
+      }
+
+    /**
+     * @brief The number of samples in a single transfer
+     */
+    std::uint32_t samples() const
+      {
+      return (length ? length : std::uint32_t{kDefaultLength}) / 2;
+      }
+
+    /**
+     * @brief The time it takes to fill a single transfer, which is the shortest possible delivery latency
+     */
+    std::chrono::microseconds period(std::uint32_t const sampleRate = dab::kDefaultSampleRate) const
+      {
+      return std::chrono::microseconds{std::uint64_t{samples()} * 1000000 / sampleRate};
+      }
+
+    /**
+     * @brief The time it takes to fill all transfers, which is the longest a consumer may stall without losses
+     */
+    std::chrono::microseconds capacity(std::uint32_t const sampleRate = dab::kDefaultSampleRate) const
+      {
+      return period(sampleRate) * (count ? count : std::uint32_t{kDefaultCount});
+      }
+
+    /**
+     * @brief The number of transfers, or 0 for the default of librtlsdr
+     */
+    std::uint32_t count;
+
+    /**
+     * @brief The length of every transfer in bytes, or 0 for the default of librtlsdr
+     */
+    std::uint32_t length;
+    };
+
   /**
    * @author Felix Morgner
    *
@@ -115,44 +223,30 @@ namespace dab
     explicit rtl_device(sample_queue_t & queue, std::size_t const index = 0) :
       device{queue}
       {
-      if(!rtlsdr_get_device_count())
-        {
-        throw std::runtime_error{"No device found!"};
-        }
-
-      if(rtlsdr_open(&m_device, index))
-        {
-        throw std::runtime_error{"Error opening device!"};
-        }
-
-      if(rtlsdr_set_sample_rate(m_device, dab::kDefaultSampleRate))
-        {
-        throw std::runtime_error{"Error setting sample rate!"};
-        }
-
-      auto gaincount = rtlsdr_get_tuner_gains(m_device, nullptr);
-      std::vector<int> gains(gaincount);
-      rtlsdr_get_tuner_gains(m_device, gains.data());
-      m_gains.reserve(gains.size());
-      for(auto gain : gains)
-        {
-        m_gains.push_back(dab::gain(gain / 10.0f));
-        }
-
-      if(rtlsdr_set_tuner_gain_mode(m_device, static_cast<int>(internal::rtl_gain_control::manual)))
-        {
-        throw std::runtime_error{"Error setting gain mode!"};
-        }
-
-      if(rtlsdr_set_tuner_gain(m_device, static_cast<int>(m_gains[m_gains.size() / 2].value() * 10)))
-        {
-        throw std::runtime_error{"Error setting gain!"};
-        }
+      open(index);
+      }
 
-      if(rtlsdr_reset_buffer(m_device))
-        {
-        throw std::runtime_error{"Error resetting buffers!"};
-        }
+    /**
+     * @brief Construct a rtl_device publishing into the given sink
+     *
+     * This constructor behaves like the queue based one, but the acquisition callback converts the samples
+     * straight into the storage provided by @p output. Combined with a dab::basic_block_pool, the callback
+     * neither allocates memory nor copies samples. The caller must guarantee that the sink stays valid for as
+     * long as samples are acquired from the device.
+     *
+     * @param output The destination for the acquired samples
+     * @param index The device index
+     *
+     * @throws std::invalid_argument if the format of @p output is not supported
+     * @throws std::runtime_exception if either no device can be found, opening the first device fails
+     * or the sample rate cannot be set to 2.048 MSps.
+     *
+     * @since 1.1.0
+     */
+    explicit rtl_device(sink & output, std::size_t const index = 0) :
+      device{conversion::converter::check(output)}
+      {
+      open(index);
       }
 
     ~rtl_device()
@@ -163,7 +257,9 @@ namespace dab
     bool tune(frequency centerFrequency) override
       {
       rtlsdr_set_center_freq(m_device, static_cast<std::uint32_t>(centerFrequency));
-      return rtlsdr_get_center_freq(m_device) == std::uint32_t(centerFrequency);
+      m_converter.update(centerFrequency);
+      auto const flushed = flush();
+      return rtlsdr_get_center_freq(m_device) == std::uint32_t(centerFrequency) && flushed;
       }
 
     bool gain(dab::gain gain) override
@@ -171,9 +267,15 @@ namespace dab
       rtlsdr_set_tuner_gain_mode(m_device, static_cast<int>(internal::rtl_gain_control::manual));
       rtlsdr_set_agc_mode(m_device, static_cast<int>(internal::rtl_agc_mode::off));
 
-      auto const realGain = closest_gain(gain);
+      auto const realGain = dab::closest_gain(m_gains, gain);
+
+      if(rtlsdr_set_tuner_gain(m_device, static_cast<int>(realGain.value() * 10)))
+        {
+        return false;
+        }
 
-      return !rtlsdr_set_tuner_gain(m_device, static_cast<int>(realGain.value() * 10));
+      m_converter.update(realGain);
+      return flush();
       }
 
     dab::gain gain() const override
@@ -186,18 +288,199 @@ namespace dab
       return m_gains;
       }
 
+    /**
+     * @brief Correct DC offset and I/Q imbalance while converting samples
+     *
+     * Once a calibration source has been installed, samples are converted through a lookup table built from
+     * the calibration for the current center frequency and gain. The table is rebuilt by #tune and #gain
+     * whenever the calibration changes. Installing an empty source restores the uncorrected conversion.
+     *
+     * @since 1.1.0
+     */
+    void calibrate(conversion::calibration_source source)
+      {
+      m_converter.calibrate(std::move(source));
+      }
+
+    /**
+     * @brief Tee the untouched bytes of every USB transfer into the given recorder
+     *
+     * The raw bytes are handed to the recorder before they are converted, independently of the sink the device
+     * delivers its samples to. Recording never blocks the acquisition: if the recorder cannot keep up, it drops
+     * and counts the bytes instead. Passing an empty pointer stops recording. The recorder may be replaced
+     * while samples are being acquired, in which case this function waits until the acquisition thread is
+     * done with the previous recorder. The previous recorder is therefore never destroyed on the acquisition
+     * thread.
+     *
+     * @since 1.1.0
+     */
+    void record(std::shared_ptr<raw_recorder> recorder)
+      {
+      std::lock_guard<std::mutex> lock{m_recorderMutex};
+      auto const retired = std::move(m_recorder);
+      m_recorder = std::move(recorder);
+      m_currentRecorder.store(m_recorder.get());
+
+      while(m_recorders.load())
+        {
+        std::this_thread::yield();
+        }
+      }
+
+    /**
+     * @brief Select the USB transfers used by the next call to #run
+     *
+     * @throws std::invalid_argument if the length of the transfers is not a multiple of
+     * dab::rtl_transfers::kLengthGranularity, which librtlsdr would silently replace by its default
+     *
+     * @since 1.1.0
+     */
+    void transfers(rtl_transfers const transfers)
+      {
+      if(transfers.length % rtl_transfers::kLengthGranularity)
+        {
+        throw std::invalid_argument{"The transfer length must be a multiple of " +
+                                    std::to_string(rtl_transfers::kLengthGranularity) + " bytes."};
+        }
+
+      m_transfers = transfers;
+      }
+
+    /**
+     * @brief Get the USB transfers used by #run
+     *
+     * @since 1.1.0
+     */
+    rtl_transfers transfers() const
+      {
+      return m_transfers;
+      }
+
+    /**
+     * @brief Hop through the channels of @p schedule while acquiring samples
+     *
+     * While a schedule is installed, #run does not stream continuously from the current frequency. Instead, the
+     * reader thread tunes to the channel of every hop in turn, discards the samples acquired while the tuner
+     * settles and delivers exactly the samples of the dwell time of the hop. Before the first samples of a hop
+     * are delivered, the center frequency of its channel is reported to the sink via dab::sink::retuned, so that
+     * consumers can attribute every block to its channel. Only delivered samples are handed to the recorder.
+     *
+     * Since the asynchronous USB transfers keep acquiring samples while the tuner is retuned, hopping reads the
+     * samples synchronously. This way, no sample acquired before a retune is ever attributed to the new channel.
+     *
+     * Passing an empty pointer returns to continuous acquisition. The schedule takes effect with the next call
+     * to #run.
+     *
+     * @throws std::logic_error if the device is running
+     *
+     * @since 1.1.0
+     */
+    void hopping(std::shared_ptr<hop_schedule const> schedule)
+      {
+      if(running())
+        {
+        throw std::logic_error{"The hop schedule cannot be changed while the device is running."};
+        }
+
+      m_schedule = std::move(schedule);
+      }
+
+    /**
+     * @brief Get the hop schedule used by #run, if any
+     *
+     * @since 1.1.0
+     */
+    std::shared_ptr<hop_schedule const> hopping() const
+      {
+      return m_schedule;
+      }
+
+    /**
+     * @brief Start sample acquisition
+     *
+     * This function starts a dedicated reader thread running the librtlsdr acquisition loop and blocks until
+     * either #stop is called or the acquisition loop terminates on its own. The thread options of the device
+     * are applied to the reader thread before the acquisition loop is entered. If a hop schedule is installed,
+     * the reader thread hops through its channels instead (see #hopping).
+     *
+     * @throws std::runtime_error if the acquisition loop terminated without #stop being called, for example
+     * because the device was unplugged.
+     * @throws std::system_error if the thread options cannot be applied to the reader thread
+     */
     void run() override
       {
-      m_running.store(true, std::memory_order_release);
+      acquisition const acquiring{*this};
 
-      auto future = std::async(std::launch::async, [&]{ rtlsdr_read_async(m_device, &internal::callback, this, 0, 0); });
+        {
+        std::lock_guard<std::mutex> lock{m_lifecycleMutex};
+        m_readerDone = false;
+        m_readerError = nullptr;
+        }
+
+      m_reader = std::thread{[this]{
+        auto result = 0;
+        auto error = std::exception_ptr{};
+
+        try
+          {
+          apply_to_current_thread(m_threading);
 
-      while(m_running)
+          if(m_schedule)
+            {
+            hop(*m_schedule);
+            }
+          else
+            {
+            result = rtlsdr_read_async(m_device, &internal::callback, this, m_transfers.count, m_transfers.length);
+            }
+          }
+        catch(...)
+          {
+          error = std::current_exception();
+          }
+
+        std::lock_guard<std::mutex> lock{m_lifecycleMutex};
+        m_readerResult = result;
+        m_readerError = error;
+        m_readerDone = true;
+        m_lifecycle.notify_all();
+      }};
+
+      auto lock = std::unique_lock<std::mutex>{m_lifecycleMutex};
+      m_lifecycle.wait(lock, [this]{ return !m_running.load(std::memory_order_acquire) || m_readerDone; });
+      auto const stopped = !m_running.load(std::memory_order_acquire);
+
+      // The acquisition loop refuses to be cancelled before it is fully set up, so keep asking until it ends.
+      while(stopped && !m_readerDone && rtlsdr_cancel_async(m_device))
         {
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        m_lifecycle.wait_for(lock, std::chrono::milliseconds{1});
         }
 
-      rtlsdr_cancel_async(m_device);
+      lock.unlock();
+      m_reader.join();
+
+      if(m_readerError)
+        {
+        std::rethrow_exception(m_readerError);
+        }
+
+      if(!stopped)
+        {
+        throw std::runtime_error{"Sample acquisition terminated unexpectedly (" + std::to_string(m_readerResult) + ")!"};
+        }
+      }
+
+    /**
+     * @brief Stop sample acquisition
+     *
+     * This function wakes up #run, which in turn cancels the librtlsdr acquisition loop. It never blocks on the
+     * acquisition loop itself.
+     */
+    void stop() override
+      {
+      std::lock_guard<std::mutex> lock{m_lifecycleMutex};
+      m_running.store(false, std::memory_order_release);
+      m_lifecycle.notify_all();
       }
 
     bool enable(option const & option) override
@@ -243,26 +526,267 @@ namespace dab
       return result;
       }
 
+    protected:
+      /**
+       * @brief Read samples from the stick on the calling thread using rtlsdr_read_sync
+       *
+       * The raw bytes are read into a buffer that is reused across calls. librtlsdr reads multiples of
+       * dab::rtl_transfers::kLengthGranularity bytes, so the samples read beyond @p count are kept for the next
+       * call, unless #tune or #gain change the tuner settings in between. Like the acquisition callback, the raw
+       * bytes are handed to the recorder of the device, if any.
+       *
+       * @throws std::runtime_error if reading from the stick fails, for example because it was unplugged
+       */
+      void pull(sink & output, std::size_t const count) override
+        {
+        for(auto remaining = count; remaining;)
+          {
+          auto const start = device_counters::clock::now();
+
+          if(m_syncOffset == m_syncLength)
+            {
+            auto const granularity = std::size_t{rtl_transfers::kLengthGranularity};
+            auto const wanted = (remaining * 2 + granularity - 1) / granularity * granularity;
+            auto const length = std::min(wanted, std::size_t{rtl_transfers::kDefaultLength});
+            m_syncBuffer.resize(std::max(m_syncBuffer.size(), length));
+
+            auto read = 0;
+            if(rtlsdr_read_sync(m_device, m_syncBuffer.data(), static_cast<int>(length), &read) || read < 2)
+              {
+              throw std::runtime_error{"Error reading samples!"};
+              }
+
+            m_syncOffset = 0;
+            m_syncLength = static_cast<std::size_t>(read) - read % 2;
+
+            tee(m_syncBuffer.data(), static_cast<std::size_t>(read));
+            }
+
+          auto const nofSamples = std::min(remaining, (m_syncLength - m_syncOffset) / 2);
+          auto const converting = device_counters::clock::now();
+          auto const result = m_converter.deliver(output, m_syncBuffer.data() + m_syncOffset, nofSamples);
+          auto const end = device_counters::clock::now();
+          m_syncOffset += nofSamples * 2;
+          remaining -= result.delivered;
+
+          m_counters.record(nofSamples, result.delivered, result.discarded, end - start, end - converting, 0);
+          }
+        }
+
     private:
-      dab::gain closest_gain(dab::gain target) const
+      /**
+       * @internal
+       *
+       * @brief Open the device with the given index and bring it into its initial state
+       */
+      void open(std::size_t const index)
         {
-        auto closest = m_gains[0];
-        for(auto && current : m_gains)
+        if(!rtlsdr_get_device_count())
+          {
+          throw std::runtime_error{"No device found!"};
+          }
+
+        if(rtlsdr_open(&m_device, index))
+          {
+          throw std::runtime_error{"Error opening device!"};
+          }
+
+        if(rtlsdr_set_sample_rate(m_device, dab::kDefaultSampleRate))
           {
-          auto toClosest = std::abs(target.value() - closest.value());
-          auto toCurrent = std::abs(target.value() - current.value());
-          if(toCurrent < toClosest)
+          throw std::runtime_error{"Error setting sample rate!"};
+          }
+
+        auto gaincount = rtlsdr_get_tuner_gains(m_device, nullptr);
+        std::vector<int> gains(gaincount);
+        rtlsdr_get_tuner_gains(m_device, gains.data());
+        m_gains.reserve(gains.size());
+        for(auto gain : gains)
+          {
+          m_gains.push_back(dab::gain(gain / 10.0f));
+          }
+
+        if(rtlsdr_set_tuner_gain_mode(m_device, static_cast<int>(internal::rtl_gain_control::manual)))
+          {
+          throw std::runtime_error{"Error setting gain mode!"};
+          }
+
+        if(rtlsdr_set_tuner_gain(m_device, static_cast<int>(m_gains[m_gains.size() / 2].value() * 10)))
+          {
+          throw std::runtime_error{"Error setting gain!"};
+          }
+
+        m_converter.update(m_gains[m_gains.size() / 2]);
+
+        if(rtlsdr_reset_buffer(m_device))
+          {
+          throw std::runtime_error{"Error resetting buffers!"};
+          }
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Discard the samples that were captured with the previous tuner settings
+       *
+       * The samples kept for the next #pull and the samples buffered by the stick are dropped, so that the next
+       * read only returns samples captured after a retune or gain change. While the acquisition loop is running,
+       * the stick must not be reset, and the samples already in flight are delivered as they arrive.
+       *
+       * @return @c false if the buffer of the stick could not be reset
+       */
+      bool flush()
+        {
+        if(m_running.load(std::memory_order_acquire))
+          {
+          return true;
+          }
+
+        m_syncOffset = m_syncLength = 0;
+        return !rtlsdr_reset_buffer(m_device);
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Hop through the channels of @p schedule on the reader thread until #stop is called
+       *
+       * Consecutive hops on the same center frequency are joined without retuning, so their samples stay
+       * contiguous. The samples discarded around a retune are reported to the sink as a discontinuity.
+       */
+      void hop(hop_schedule const & schedule)
+        {
+        auto const sampleRate = rtlsdr_get_sample_rate(m_device);
+        auto tuned = false;
+        auto tunedFrequency = std::uint32_t{};
+        m_syncOffset = m_syncLength = 0;
+
+        for(auto index = std::size_t{}; m_running.load(std::memory_order_acquire); index = (index + 1) % schedule.size())
+          {
+          auto const & channel = schedule[index].channel;
+          auto const centerFrequency = static_cast<std::uint32_t>(channel.freq);
+
+          if(!tuned || centerFrequency != tunedFrequency)
+            {
+            // The samples read ahead of the retune were captured at the previous frequency
+            auto const stale = (m_syncLength - m_syncOffset) / 2;
+            m_syncOffset = m_syncLength = 0;
+
+            if(rtlsdr_set_center_freq(m_device, centerFrequency) || rtlsdr_reset_buffer(m_device))
+              {
+              throw std::runtime_error{std::string{"Error tuning to channel "} + channel.label + "!"};
+              }
+
+            m_converter.update(channel.freq);
+            auto const settled = dwell(schedule.settle_samples(sampleRate), false);
+
+            if(tuned)
+              {
+              m_converter.skip(m_output, stale + settled);
+              }
+
+            tuned = true;
+            tunedFrequency = centerFrequency;
+            }
+
+          dwell(schedule.dwell_samples(index, sampleRate), true);
+          }
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Synchronously read @p count samples in portions of at most one transfer, and deliver them if
+       * @p deliver is @c true
+       *
+       * Like #pull, the samples read beyond @p count are kept for the next call.
+       *
+       * @return The number of samples read, which is less than @p count only if #stop was called
+       */
+      std::size_t dwell(std::size_t const count, bool const deliver)
+        {
+        auto const granularity = std::size_t{rtl_transfers::kLengthGranularity};
+        auto remaining = count;
+
+        while(remaining && m_running.load(std::memory_order_acquire))
+          {
+          auto const start = device_counters::clock::now();
+
+          if(m_syncOffset == m_syncLength)
+            {
+            auto const wanted = std::min(remaining, std::size_t{m_transfers.samples()});
+            auto const length = (wanted * 2 + granularity - 1) / granularity * granularity;
+            m_syncBuffer.resize(std::max(m_syncBuffer.size(), length));
+
+            auto read = 0;
+            if(rtlsdr_read_sync(m_device, m_syncBuffer.data(), static_cast<int>(length), &read) || read < 2)
+              {
+              throw std::runtime_error{"Error reading samples!"};
+              }
+
+            m_syncOffset = 0;
+            m_syncLength = static_cast<std::size_t>(read) - read % 2;
+            }
+
+          auto const data = m_syncBuffer.data() + m_syncOffset;
+          auto const nofSamples = std::min(remaining, (m_syncLength - m_syncOffset) / 2);
+          m_syncOffset += nofSamples * 2;
+          remaining -= nofSamples;
+
+          if(deliver)
             {
-            closest = current;
+            tee(data, nofSamples * 2);
+
+            m_converter.announce(m_output, nofSamples, start);
+            auto const converting = device_counters::clock::now();
+            auto const policy = m_overflow.load(std::memory_order_relaxed);
+            auto const result = m_converter.deliver(m_output, data, nofSamples, policy, &m_running);
+            auto const end = device_counters::clock::now();
+
+            m_counters.record(nofSamples, result.delivered, result.discarded, end - start, end - converting,
+                              m_output.buffered());
             }
           }
 
-        return closest;
+        return count - remaining;
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Hand @p length raw bytes to the recorder of the device, if any
+       *
+       * Announcing the acquisition thread before loading the recorder ensures that #record either sees the
+       * thread, or the thread sees the new recorder. Like the conversion, this never takes a lock, not even the
+       * one std::atomic_load takes for a std::shared_ptr.
+       */
+      void tee(std::uint8_t const * raw, std::size_t const length)
+        {
+        m_recorders.fetch_add(1);
+        if(auto const recorder = m_currentRecorder.load())
+          {
+          recorder->record(raw, length);
+          }
+        m_recorders.fetch_sub(1);
         }
 
       rtlsdr_dev_t * m_device{};
       std::vector<dab::gain> m_gains{};
-      std::vector<internal::sample_t> m_sampleBuffer{};
+      conversion::converter m_converter{};
+      std::mutex m_recorderMutex{};
+      std::shared_ptr<raw_recorder> m_recorder{};
+      std::atomic<raw_recorder *> m_currentRecorder{};
+      std::atomic<std::size_t> m_recorders{};
+      rtl_transfers m_transfers{};
+      std::shared_ptr<hop_schedule const> m_schedule{};
+      std::vector<std::uint8_t> m_syncBuffer{};
+      std::size_t m_syncOffset{};
+      std::size_t m_syncLength{};
+      std::thread m_reader{};
+      std::mutex m_lifecycleMutex{};
+      std::condition_variable m_lifecycle{};
+      bool m_readerDone{};
+      int m_readerResult{};
+      std::exception_ptr m_readerError{};
 
       friend void internal::callback(unsigned char * buffer, std::uint32_t length, void * context);
     };
@@ -272,17 +796,18 @@ namespace dab
     extern "C" void callback(unsigned char * buffer, std::uint32_t length, void * context)
       {
       rtl_device * device = static_cast<rtl_device *>(context);
-      auto & samplesQueue = device->m_samples;
-      auto & sampleBuffer = device->m_sampleBuffer;
+      auto const start = device_counters::clock::now();
 
-      sampleBuffer.resize(length / 2);
+      device->tee(buffer, length);
 
-      for(std::uint32_t idx = 0; idx < length; idx += 2)
-        {
-        sampleBuffer[idx / 2] = internal::sample_t{ float(buffer[idx] - 128) / 128, float(buffer[idx + 1] - 128) / 128 };
-        }
+      device->m_converter.announce(device->m_output, length / 2, start);
+      auto const converting = device_counters::clock::now();
+      auto const policy = device->m_overflow.load(std::memory_order_relaxed);
+      auto const result = device->m_converter.deliver(device->m_output, buffer, length / 2, policy, &device->m_running);
+      auto const end = device_counters::clock::now();
 
-      samplesQueue.enqueue(sampleBuffer);
+      device->m_counters.record(length / 2, result.delivered, result.discarded, end - start, end - converting,
+                                device->m_output.buffered());
       }
     }
 
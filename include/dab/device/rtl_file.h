@@ -32,13 +32,11 @@
 #ifndef DABDEVICE__RTL_FILE
 #define DABDEVICE__RTL_FILE
 
-#include "dab/device/device.h"
-#include "dab/types/gain.h"
-
-#include <dab/types/common_types.h>
+#include "dab/device/file_device.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
-#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -51,9 +49,9 @@ namespace dab
    * @brief Concrete implementation of dab::device for IQ-sample dumps acquired from RTLSDR USB sticks
    *
    * This class is enables the use of IQ dumps that have been acquired with the rtl_sdr utility that
-   * ships as part of librtlsdr.
+   * ships as part of librtlsdr. Tuning, gain, calibration, pacing and looping are handled by dab::file_device.
    */
-  struct rtl_file : device
+  struct rtl_file : file_device
     {
     /**
      * @author Felix Morgner
@@ -63,124 +61,101 @@ namespace dab
      * This constructor initializes the device to the specified queue and open the file with the specified
      * name for reading. The caller must guarantee that the queue stays valid for as long as samples are
      * acquired from the device.
+     *
+     * The file is read in blocks of @p blockSize bytes. Each block is converted in one pass and handed
+     * to the queue as a whole.
+     *
+     * @throws std::invalid_argument if @p blockSize is zero or not a multiple of 2
+     * @throws std::ios::failure if the file cannot be opened or is shorter than 2 bytes
      */
-    rtl_file(sample_queue_t & samples, std::string const & filename) :
-      device{samples},
+    rtl_file(sample_queue_t & samples, std::string const & filename, std::size_t const blockSize = kDefaultBlockSize) :
+      file_device{samples, blockSize},
       m_filename{filename},
       m_fileStream{filename, std::ios::binary}
       {
-      if(!m_fileStream)
-        {
-        throw std::ios::failure{std::string{"Failed to open file '"} + m_filename + "'."};
-        }
-
-      m_fileStream.seekg(0, std::ios::end);
-      std::size_t size = m_fileStream.tellg();
-      m_fileStream.seekg(0);
-
-      if(size < 2)
-        {
-        throw std::ios::failure{std::string{"File '"} + m_filename + "' is shorter than 2 bytes."};
-        }
-      }
-
-    bool tune(frequency) override
-      {
-      return true;
-      }
-
-    bool gain(dab::gain) override
-      {
-      return true;
+      open();
       }
 
-    dab::gain gain() const override
+    /**
+     * @brief Construct a rtl_file meta device publishing into the given sink
+     *
+     * This constructor behaves like the queue based one, but converts the samples straight into the storage
+     * provided by @p output. The caller must guarantee that the sink stays valid for as long as samples are
+     * acquired from the device.
+     *
+     * @throws std::invalid_argument if @p blockSize is zero or not a multiple of 2, or if the format of
+     * @p output is not supported
+     * @throws std::ios::failure if the file cannot be opened or is shorter than 2 bytes
+     *
+     * @since 1.1.0
+     */
+    rtl_file(sink & output, std::string const & filename, std::size_t const blockSize = kDefaultBlockSize) :
+      file_device{output, blockSize},
+      m_filename{filename},
+      m_fileStream{filename, std::ios::binary}
       {
-      using namespace dab::literals;
-      return 0.0_dB;
+      open();
       }
 
-    std::vector<dab::gain> gains() const override
+    static std::vector<descriptor> descriptors()
       {
-      return {};
+      return {
+        {0, "0x0042", "RTL Raw File", "Opendigitalradio", typeid(rtl_file)},
+      };
       }
 
-    void run() override
-      {
-      m_running.store(true, std::memory_order_release);
-
-      while(m_running)
+    protected:
+      bool exhausted() const override
         {
-        auto sample = get_sample();
-
-        if(m_fileStream.eof())
-          {
-          if(m_doLoop)
-            {
-            m_fileStream.seekg(0);
-            sample = get_sample();
-            }
-          else
-            {
-            stop();
-            continue;
-            }
-          }
-
-        m_samples.enqueue(std::move(sample));
+        return m_fileStream.eof();
         }
-      }
 
-    bool enable(option const & option) override
-      {
-      if(option == option::loop)
+      void rewind() override
         {
-        m_doLoop = true;
-        return true;
+        m_fileStream.clear();
+        m_fileStream.seekg(0);
         }
 
-      return false;
-      }
-
-    bool disable(option const & option) override
-      {
-      if(option == option::loop)
+      /**
+       * @brief Read the next block of at most @p length bytes from the file into #m_rawBuffer
+       */
+      std::uint8_t const * next_block(std::size_t const length, std::size_t & nofSamples) override
         {
-        m_doLoop = false;
-        return true;
+        m_fileStream.read(reinterpret_cast<char *>(m_rawBuffer.data()), length);
+        nofSamples = static_cast<std::size_t>(m_fileStream.gcount()) / 2;
+        return m_rawBuffer.data();
         }
 
-      return false;
-      }
-
-    static std::vector<descriptor> descriptors()
-      {
-      return {
-        {0, "0x0042", "RTL Raw File", "Opendigitalradio", typeid(rtl_file)},
-      };
-      }
-
     private:
-      internal::sample_t get_sample()
+      /**
+       * @internal
+       *
+       * @brief Validate the opened file and allocate the read buffer
+       */
+      void open()
         {
-        std::uint8_t real{0};
-        std::uint8_t imag{0};
+        if(!m_fileStream)
+          {
+          throw std::ios::failure{std::string{"Failed to open file '"} + m_filename + "'."};
+          }
 
-        m_fileStream.read((char *)&real, 1);
-        m_fileStream.read((char *)&imag, 1);
+        m_fileStream.seekg(0, std::ios::end);
+        std::size_t size = m_fileStream.tellg();
+        m_fileStream.seekg(0);
 
-        float floating_real = real;
-        float floating_imag = imag;
+        if(size < 2)
+          {
+          throw std::ios::failure{std::string{"File '"} + m_filename + "' is shorter than 2 bytes."};
+          }
 
-        return internal::sample_t{(floating_real - 128) / 128, (floating_imag - 128) / 128};
+        m_rawBuffer.resize(m_blockSize);
         }
 
       std::string const m_filename;
       std::ifstream m_fileStream;
-      bool m_doLoop{};
+      std::vector<std::uint8_t> m_rawBuffer{};
     };
 
   }
 
 #endif
-
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE__RTL_MMAP_FILE
+#define DABDEVICE__RTL_MMAP_FILE
+
+#include "dab/device/file_device.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <string>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief Concrete implementation of dab::device for memory-mapped IQ-sample dumps acquired from RTLSDR USB sticks
+   *
+   * This class provides the same functionality as dab::rtl_file, but instead of reading the dump through a
+   * stream, the whole file is mapped into memory and samples are converted straight from the mapping. Since
+   * the mapping is backed by the page cache, multiple concurrent replays of the same dump share the same
+   * physical memory. Pages in front of the current read position are prefetched, while pages that have
+   * already been consumed are released from the resident set of the process.
+   *
+   * @since 1.1.0
+   */
+  struct rtl_mmap_file : file_device
+    {
+    /**
+     * @brief The number of blocks prefetched in front of the current read position
+     *
+     * @since 1.1.0
+     */
+    static std::size_t constexpr kReadAheadBlocks = 16;
+
+    /**
+     * @brief Construct a rtl_mmap_file meta device with the target sample queue and filename
+     *
+     * This constructor initializes the device to the specified queue and maps the file with the specified
+     * name into memory. The caller must guarantee that the queue stays valid for as long as samples are
+     * acquired from the device.
+     *
+     * @throws std::invalid_argument if @p blockSize is zero or not a multiple of 2
+     * @throws std::ios::failure if the file cannot be opened or mapped, or is shorter than 2 bytes
+     */
+    rtl_mmap_file(sample_queue_t & samples, std::string const & filename, std::size_t const blockSize = kDefaultBlockSize) :
+      file_device{samples, blockSize},
+      m_filename{filename},
+      m_pageSize{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))}
+      {
+      map();
+      }
+
+    /**
+     * @brief Construct a rtl_mmap_file meta device publishing into the given sink
+     *
+     * This constructor behaves like the queue based one, but converts the samples straight from the mapping
+     * into the storage provided by @p output. The caller must guarantee that the sink stays valid for as long
+     * as samples are acquired from the device.
+     *
+     * @throws std::invalid_argument if @p blockSize is zero or not a multiple of 2, or if the format of
+     * @p output is not supported
+     * @throws std::ios::failure if the file cannot be opened or mapped, or is shorter than 2 bytes
+     */
+    rtl_mmap_file(sink & output, std::string const & filename, std::size_t const blockSize = kDefaultBlockSize) :
+      file_device{output, blockSize},
+      m_filename{filename},
+      m_pageSize{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))}
+      {
+      map();
+      }
+
+    rtl_mmap_file(rtl_mmap_file const &) = delete;
+    rtl_mmap_file & operator=(rtl_mmap_file const &) = delete;
+
+    ~rtl_mmap_file()
+      {
+      munmap(const_cast<std::uint8_t *>(m_mapping), m_size);
+      }
+
+    static std::vector<descriptor> descriptors()
+      {
+      return {
+        {0, "0x0043", "RTL Raw File (memory-mapped)", "Opendigitalradio", typeid(rtl_mmap_file)},
+      };
+      }
+
+    protected:
+      bool exhausted() const override
+        {
+        return m_offset == m_size - m_size % 2;
+        }
+
+      void rewind() override
+        {
+        m_offset = 0;
+        m_prefetched = 0;
+        m_released = 0;
+        }
+
+      /**
+       * @brief Get the next block of at most @p length bytes straight from the mapping
+       */
+      std::uint8_t const * next_block(std::size_t const length, std::size_t & nofSamples) override
+        {
+        auto const block = std::min(length, m_size - m_size % 2 - m_offset);
+        advise(m_offset + block);
+
+        auto const raw = m_mapping + m_offset;
+        m_offset += block;
+        nofSamples = block / 2;
+        return raw;
+        }
+
+    private:
+      /**
+       * @internal
+       *
+       * @brief Map the file into memory
+       */
+      void map()
+        {
+        auto const descriptor = ::open(m_filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if(descriptor < 0)
+          {
+          throw std::ios::failure{std::string{"Failed to open file '"} + m_filename + "'."};
+          }
+
+        struct stat status{};
+        if(fstat(descriptor, &status))
+          {
+          close(descriptor);
+          throw std::ios::failure{std::string{"Failed to determine the size of file '"} + m_filename + "'."};
+          }
+
+        m_size = static_cast<std::size_t>(status.st_size);
+        if(m_size < 2)
+          {
+          close(descriptor);
+          throw std::ios::failure{std::string{"File '"} + m_filename + "' is shorter than 2 bytes."};
+          }
+
+        auto const mapping = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, descriptor, 0);
+        close(descriptor);
+
+        if(mapping == MAP_FAILED)
+          {
+          throw std::ios::failure{std::string{"Failed to map file '"} + m_filename + "'."};
+          }
+
+        m_mapping = static_cast<std::uint8_t const *>(mapping);
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Slide the prefetch/release window so that it covers the data up to @p consumedUntil
+       *
+       * Pages of the read-ahead window are requested from the kernel with MADV_WILLNEED. Pages that lie
+       * completely behind the current read position are dropped from the resident set with MADV_DONTNEED.
+       * Since the mapping is read-only and shared, the pages stay in the page cache and are not lost.
+       */
+      void advise(std::size_t const consumedUntil)
+        {
+        auto const base = const_cast<std::uint8_t *>(m_mapping);
+
+        auto const prefetchEnd = std::min(m_size, consumedUntil + kReadAheadBlocks * m_blockSize);
+        if(prefetchEnd > m_prefetched)
+          {
+          auto const start = m_prefetched - m_prefetched % m_pageSize;
+          madvise(base + start, prefetchEnd - start, MADV_WILLNEED);
+          m_prefetched = prefetchEnd;
+          }
+
+        auto const releaseEnd = m_offset - m_offset % m_pageSize;
+        if(releaseEnd > m_released)
+          {
+          madvise(base + m_released, releaseEnd - m_released, MADV_DONTNEED);
+          m_released = releaseEnd;
+          }
+        }
+
+      std::string const m_filename;
+      std::size_t const m_pageSize;
+      std::uint8_t const * m_mapping{};
+      std::size_t m_size{};
+      std::size_t m_offset{};
+      std::size_t m_prefetched{};
+      std::size_t m_released{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,471 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE__SCANNER
+#define DABDEVICE__SCANNER
+
+#include "dab/constants/channels.h"
+#include "dab/conversion/power.h"
+#include "dab/device/device.h"
+#include "dab/device/device_group.h"
+#include "dab/types/channel.h"
+#include "dab/types/frequency.h"
+#include "dab/types/raw_sample.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The settings of a channel scan
+   *
+   * @since 1.1.0
+   */
+  struct scan_options
+    {
+    /**
+     * @brief The time to wait after tuning to a channel, to let the tuner PLL and the AGC settle
+     */
+    std::chrono::milliseconds settle{10};
+
+    /**
+     * @brief The number of samples to discard after settling, since they may still have been acquired while tuning
+     */
+    std::size_t discard{16 * 1024};
+
+    /**
+     * @brief The number of samples the power of a channel is measured over
+     */
+    std::size_t samples{64 * 1024};
+
+    /**
+     * @brief The margin above the noise floor in dB from which on a channel is considered to be occupied
+     */
+    double threshold{10.0};
+    };
+
+  /**
+   * @brief The measured occupancy of a single channel
+   *
+   * @since 1.1.0
+   */
+  struct channel_occupancy
+    {
+    /**
+     * @brief The label of the channel, like "5C"
+     */
+    std::string label;
+
+    /**
+     * @brief The center frequency of the channel
+     */
+    frequency freq;
+
+    /**
+     * @brief The mean power of the channel in dB relative to full scale, limited to #kFloor
+     */
+    double power;
+
+    /**
+     * @brief The distance of #power above the noise floor of the scan in dB
+     */
+    double margin;
+
+    /**
+     * @brief Whether #margin reached the threshold of the scan
+     */
+    bool occupied;
+
+    /**
+     * @brief The lowest power that is reported, which is well below the quantization noise of the RTL2832U
+     */
+    static double constexpr kFloor = -120.0;
+    };
+
+  /**
+   * @brief The result of a channel scan, ranked by descending power
+   *
+   * @since 1.1.0
+   */
+  struct occupancy_map
+    {
+    /**
+     * @brief The time the scan was performed
+     */
+    std::chrono::system_clock::time_point time;
+
+    /**
+     * @brief The scanned channels, the strongest one first
+     */
+    std::vector<channel_occupancy> channels;
+    };
+
+  /**
+   * @brief Get the list of all standard DAB channels in Band III
+   *
+   * @see dab::kChannels
+   *
+   * @since 1.1.0
+   */
+  inline std::vector<channel> band_iii_channels()
+    {
+    return {kChannels.begin(), kChannels.end()};
+    }
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief Tune @p device to @p channel and measure its mean power
+     *
+     * The samples are read synchronously into @p buffer, without conversion, so that the power can be computed
+     * by the vectorized energy kernels straight from the raw bytes.
+     */
+    inline channel_occupancy measure(device & device, channel const & channel, scan_options const & options,
+                                     std::vector<raw_sample> & buffer)
+      {
+      if(!device.tune(channel.freq))
+        {
+        throw std::runtime_error{std::string{"Failed to tune to channel "} + channel.label + "."};
+        }
+
+      std::this_thread::sleep_for(options.settle);
+      buffer.resize(std::max(options.discard, options.samples));
+
+      if(options.discard)
+        {
+        device.read(buffer.data(), options.discard);
+        }
+
+      auto const nofSamples = device.read(buffer.data(), options.samples);
+      auto const power = conversion::mean_power(reinterpret_cast<std::uint8_t const *>(buffer.data()), nofSamples);
+      auto const level = power > 0.0 ? std::max(10.0 * std::log10(power), double{channel_occupancy::kFloor})
+                                     : double{channel_occupancy::kFloor};
+
+      return {channel.label, channel.freq, level, 0.0, false};
+      }
+
+    /**
+     * @internal
+     *
+     * @brief Rank the measured channels and classify them against the noise floor
+     *
+     * Since most channels are empty at any location, the median power of all channels serves as the estimate of
+     * the noise floor.
+     */
+    inline occupancy_map rank(std::vector<channel_occupancy> measured, double const threshold)
+      {
+      if(!measured.empty())
+        {
+        auto levels = std::vector<double>{};
+        levels.reserve(measured.size());
+
+        for(auto const & channel : measured)
+          {
+          levels.push_back(channel.power);
+          }
+
+        std::nth_element(levels.begin(), levels.begin() + levels.size() / 2, levels.end());
+        auto const floor = levels[levels.size() / 2];
+
+        for(auto & channel : measured)
+          {
+          channel.margin = channel.power - floor;
+          channel.occupied = channel.margin >= threshold;
+          }
+
+        std::stable_sort(measured.begin(), measured.end(), [](channel_occupancy const & lhs, channel_occupancy const & rhs){
+          return lhs.power > rhs.power;
+        });
+        }
+
+      return {std::chrono::system_clock::now(), std::move(measured)};
+      }
+
+    /**
+     * @internal
+     *
+     * @brief Check whether @p map contains exactly the channels in @p channels
+     */
+    inline bool covers(occupancy_map const & map, std::vector<channel> const & channels)
+      {
+      if(map.channels.size() != channels.size())
+        {
+        return false;
+        }
+
+      return std::all_of(channels.begin(), channels.end(), [&](channel const & wanted){
+        return std::any_of(map.channels.begin(), map.channels.end(), [&](channel_occupancy const & cached){
+          return cached.label == wanted.label && std::uint32_t(cached.freq) == std::uint32_t(wanted.freq);
+        });
+      });
+      }
+
+    }
+
+  /**
+   * @brief Scan the given channels with a single device
+   *
+   * Every channel is tuned to in turn. After waiting for the tuner to settle, the power of the channel is measured
+   * over a block of samples read synchronously from the device. The power is a wideband measure over the whole
+   * sample rate, which suffices to tell occupied multiplexes from empty channels, but does not replace the
+   * synchronization of a receiver.
+   *
+   * @note The device must not be running, since the samples are read synchronously.
+   *
+   * @throws std::runtime_error if the device fails to tune to one of the channels
+   * @throws std::logic_error if the device does not support reading samples synchronously
+   *
+   * @since 1.1.0
+   */
+  inline occupancy_map scan(device & device, std::vector<channel> const & channels, scan_options const & options = {})
+    {
+    auto buffer = std::vector<raw_sample>{};
+    auto measured = std::vector<channel_occupancy>{};
+    measured.reserve(channels.size());
+
+    for(auto const & channel : channels)
+      {
+      measured.push_back(internal::measure(device, channel, options, buffer));
+      }
+
+    return internal::rank(std::move(measured), options.threshold);
+    }
+
+  /**
+   * @brief Scan the given channels with all devices of a group in parallel
+   *
+   * The channels are dealt out to the devices in turn, and every device scans its share on its own thread. With
+   * n devices, a scan thus takes about 1/n of the time a single device takes. The result is identical to the one
+   * of a single device, provided that all devices receive the same signals.
+   *
+   * @note The devices of the group must not be running, since the samples are read synchronously.
+   *
+   * @throws std::invalid_argument if the group is empty
+   * @throws Any exception thrown while scanning with one of the devices. The first such exception is rethrown
+   * once all devices have finished their share.
+   *
+   * @since 1.1.0
+   */
+  template<typename DeviceType, typename TransportType>
+  occupancy_map scan(device_group<DeviceType, TransportType> & devices, std::vector<channel> const & channels,
+                     scan_options const & options = {})
+    {
+    if(!devices.size())
+      {
+      throw std::invalid_argument{"Cannot scan without any devices."};
+      }
+
+    auto shares = std::vector<std::future<std::vector<channel_occupancy>>>{};
+
+    for(auto index = std::size_t{}; index < devices.size(); ++index)
+      {
+      shares.push_back(std::async(std::launch::async, [&, index]{
+        auto buffer = std::vector<raw_sample>{};
+        auto measured = std::vector<channel_occupancy>{};
+
+        for(auto next = index; next < channels.size(); next += devices.size())
+          {
+          measured.push_back(internal::measure(devices[index], channels[next], options, buffer));
+          }
+
+        return measured;
+      }));
+      }
+
+    auto measured = std::vector<channel_occupancy>{};
+    auto error = std::exception_ptr{};
+
+    for(auto & share : shares)
+      {
+      try
+        {
+        auto part = share.get();
+        measured.insert(measured.end(), part.begin(), part.end());
+        }
+      catch(...)
+        {
+        if(!error)
+          {
+          error = std::current_exception();
+          }
+        }
+      }
+
+    if(error)
+      {
+      std::rethrow_exception(error);
+      }
+
+    return internal::rank(std::move(measured), options.threshold);
+    }
+
+  /**
+   * @brief Write an occupancy map to the file at @p path
+   *
+   * The map is written to a temporary file next to @p path first, which then replaces @p path. This way, a
+   * concurrent #load_occupancy never observes a partially written map.
+   *
+   * @throws std::ios::failure if the file cannot be written
+   *
+   * @since 1.1.0
+   */
+  inline void save_occupancy(occupancy_map const & map, std::string const & path)
+    {
+    auto const temporary = path + ".tmp";
+
+      {
+      std::ofstream file{temporary};
+      file.precision(std::numeric_limits<double>::max_digits10);
+      file << "# libdabdevice occupancy 1 " << std::chrono::system_clock::to_time_t(map.time) << '\n';
+
+      for(auto const & channel : map.channels)
+        {
+        file << channel.label << ' ' << std::uint32_t(channel.freq) << ' ' << channel.power << ' ' << channel.margin
+             << ' ' << channel.occupied << '\n';
+        }
+
+      if(!file.flush())
+        {
+        throw std::ios::failure{"Failed to write occupancy map '" + temporary + "'."};
+        }
+      }
+
+    if(std::rename(temporary.c_str(), path.c_str()))
+      {
+      std::remove(temporary.c_str());
+      throw std::ios::failure{"Failed to replace occupancy map '" + path + "'."};
+      }
+    }
+
+  /**
+   * @brief Read an occupancy map written by #save_occupancy from the file at @p path
+   *
+   * @note The time of the map is stored with a resolution of one second.
+   *
+   * @throws std::ios::failure if the file cannot be read or does not contain an occupancy map
+   *
+   * @since 1.1.0
+   */
+  inline occupancy_map load_occupancy(std::string const & path)
+    {
+    std::ifstream file{path};
+    if(!file)
+      {
+      throw std::ios::failure{"Failed to open occupancy map '" + path + "'."};
+      }
+
+    auto marker = std::string{};
+    auto library = std::string{};
+    auto kind = std::string{};
+    auto version = 0;
+    auto time = std::time_t{};
+
+    if(!(file >> marker >> library >> kind >> version >> time) || marker != "#" || library != "libdabdevice" ||
+       kind != "occupancy" || version != 1)
+      {
+      throw std::ios::failure{"File '" + path + "' does not contain an occupancy map."};
+      }
+
+    auto map = occupancy_map{std::chrono::system_clock::from_time_t(time), {}};
+    auto label = std::string{};
+    auto hertz = std::uint32_t{};
+    auto power = 0.0;
+    auto margin = 0.0;
+    auto occupied = false;
+
+    while(file >> label >> hertz >> power >> margin >> occupied)
+      {
+      map.channels.push_back({label, frequency{hertz}, power, margin, occupied});
+      }
+
+    if(!file.eof())
+      {
+      throw std::ios::failure{"Occupancy map '" + path + "' is malformed."};
+      }
+
+    return map;
+    }
+
+  /**
+   * @brief Scan the given channels, unless a recent enough scan of them is cached at @p path
+   *
+   * The cached map is used if it is at most @p maxAge old and contains exactly the channels in @p channels.
+   * Otherwise, the channels are scanned and the result replaces the cached map. A missing or unreadable cache is
+   * not an error.
+   *
+   * @tparam DevicesType Either a dab::device or a dab::device_group, which is passed to dab::scan
+   *
+   * @throws Any exception thrown by dab::scan or dab::save_occupancy
+   *
+   * @since 1.1.0
+   */
+  template<typename DevicesType>
+  occupancy_map cached_scan(DevicesType & devices, std::vector<channel> const & channels, std::string const & path,
+                            std::chrono::seconds const maxAge, scan_options const & options = {})
+    {
+    try
+      {
+      auto cached = load_occupancy(path);
+      if(std::chrono::system_clock::now() - cached.time <= maxAge && internal::covers(cached, channels))
+        {
+        return cached;
+        }
+      }
+    catch(std::ios::failure const &)
+      {
+      }
+
+    auto fresh = scan(devices, channels, options);
+    save_occupancy(fresh, path);
+    return fresh;
+    }
+
+  }
+
+#endif
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_DEVICE_THREAD_OPTIONS
+#define DABDEVICE_DEVICE_THREAD_OPTIONS
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The scheduling policies a device thread can run with
+   *
+   * @since 1.1.0
+   */
+  enum struct scheduling_policy : std::uint8_t
+    {
+    /**
+     * @brief Keep the scheduling policy the thread was created with
+     */
+    inherit,
+
+    /**
+     * @brief Real-time first-in, first-out scheduling (SCHED_FIFO)
+     */
+    fifo,
+
+    /**
+     * @brief Real-time round-robin scheduling (SCHED_RR)
+     */
+    round_robin,
+    };
+
+  /**
+   * @brief The settings applied to the threads acquiring samples for a device
+   *
+   * The default constructed options leave the threads untouched. Raising the scheduling policy to a real-time
+   * one and locking memory usually require elevated privileges, like CAP_SYS_NICE and CAP_IPC_LOCK on Linux.
+   *
+   * @see dab::device::threading
+   * @since 1.1.0
+   */
+  struct thread_options
+    {
+    /**
+     * @brief The CPUs the thread may run on, or any CPU if empty
+     */
+    std::vector<unsigned> cpus{};
+
+    /**
+     * @brief The scheduling policy of the thread
+     */
+    scheduling_policy scheduling{scheduling_policy::inherit};
+
+    /**
+     * @brief The real-time priority of the thread, which is ignored unless #scheduling is a real-time policy
+     */
+    int priority{};
+
+    /**
+     * @brief The name of the thread, which is limited to 15 characters on Linux, or the inherited name if empty
+     */
+    std::string name{};
+
+    /**
+     * @brief Lock all current and future pages of the process, including the sample buffers, into memory
+     *
+     * Locked pages are never swapped out, so the acquisition thread never waits for a page fault. Since the
+     * lock is implemented using mlockall, it affects the whole process.
+     */
+    bool lockMemory{};
+    };
+
+  /**
+   * @brief Apply @p options to the calling thread
+   *
+   * @throws std::system_error if one of the options cannot be applied, for example because of missing
+   * privileges or because it is not supported on this platform. The options are applied in the order they are
+   * declared in, so the ones preceding the failed option remain in effect.
+   *
+   * @since 1.1.0
+   */
+  inline void apply_to_current_thread(thread_options const & options)
+    {
+    auto const self = pthread_self();
+
+    if(!options.cpus.empty())
+      {
+#if defined(__linux__)
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      for(auto const cpu : options.cpus)
+        {
+        if(cpu >= CPU_SETSIZE)
+          {
+          throw std::system_error{EINVAL, std::generic_category(), "CPU " + std::to_string(cpu) + " does not exist"};
+          }
+        CPU_SET(cpu, &cpus);
+        }
+
+      if(auto const error = pthread_setaffinity_np(self, sizeof(cpus), &cpus))
+        {
+        throw std::system_error{error, std::generic_category(), "Failed to set the CPU affinity"};
+        }
+#else
+      throw std::system_error{ENOTSUP, std::generic_category(), "Failed to set the CPU affinity"};
+#endif
+      }
+
+    if(options.scheduling != scheduling_policy::inherit)
+      {
+      auto const policy = options.scheduling == scheduling_policy::fifo ? SCHED_FIFO : SCHED_RR;
+      auto parameters = sched_param{};
+      parameters.sched_priority = options.priority;
+
+      if(auto const error = pthread_setschedparam(self, policy, &parameters))
+        {
+        throw std::system_error{error, std::generic_category(), "Failed to set the scheduling policy"};
+        }
+      }
+
+    if(!options.name.empty())
+      {
+#if defined(__linux__)
+      if(auto const error = pthread_setname_np(self, options.name.c_str()))
+        {
+        throw std::system_error{error, std::generic_category(), "Failed to set the thread name"};
+        }
+#else
+      throw std::system_error{ENOTSUP, std::generic_category(), "Failed to set the thread name"};
+#endif
+      }
+
+    if(options.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE))
+      {
+      throw std::system_error{errno, std::generic_category(), "Failed to lock memory"};
+      }
+    }
+
+  /**
+   * @brief Apply thread options to the calling thread for the lifetime of the object
+   *
+   * The CPU affinity, scheduling policy and name the calling thread had before are saved on construction and
+   * restored on destruction, so that a thread can be borrowed for sample acquisition and handed back unchanged.
+   * Locked memory is not unlocked again, since the lock applies to the whole process.
+   *
+   * @since 1.1.0
+   */
+  struct scoped_thread_options
+    {
+    /**
+     * @brief Save the settings of the calling thread and apply @p options to it
+     *
+     * @throws std::system_error if one of the options cannot be applied, in which case the settings saved
+     * before are restored again
+     */
+    explicit scoped_thread_options(thread_options const & options) :
+      m_options{options}
+      {
+      auto const self = pthread_self();
+
+#if defined(__linux__)
+      if(!m_options.cpus.empty())
+        {
+        pthread_getaffinity_np(self, sizeof(m_cpus), &m_cpus);
+        }
+
+      if(!m_options.name.empty())
+        {
+        pthread_getname_np(self, m_name, sizeof(m_name));
+        }
+#endif
+
+      if(m_options.scheduling != scheduling_policy::inherit)
+        {
+        pthread_getschedparam(self, &m_policy, &m_parameters);
+        }
+
+      try
+        {
+        apply_to_current_thread(m_options);
+        }
+      catch(...)
+        {
+        restore();
+        throw;
+        }
+      }
+
+    scoped_thread_options(scoped_thread_options const &) = delete;
+    scoped_thread_options & operator=(scoped_thread_options const &) = delete;
+
+    /**
+     * @brief Restore the settings the calling thread had before the options were applied
+     *
+     * Settings that cannot be restored are left as they are.
+     */
+    ~scoped_thread_options()
+      {
+      restore();
+      }
+
+    private:
+      void restore()
+        {
+        auto const self = pthread_self();
+
+#if defined(__linux__)
+        if(!m_options.cpus.empty())
+          {
+          pthread_setaffinity_np(self, sizeof(m_cpus), &m_cpus);
+          }
+
+        if(!m_options.name.empty() && m_name[0])
+          {
+          pthread_setname_np(self, m_name);
+          }
+#endif
+
+        if(m_options.scheduling != scheduling_policy::inherit)
+          {
+          pthread_setschedparam(self, m_policy, &m_parameters);
+          }
+        }
+
+      thread_options const m_options;
+#if defined(__linux__)
+      cpu_set_t m_cpus{};
+      char m_name[16]{};
+#endif
+      int m_policy{};
+      sched_param m_parameters{};
+    };
+
+  }
+
+#endif
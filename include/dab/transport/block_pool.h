@@ -0,0 +1,586 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TRANSPORT_BLOCK_POOL
+#define DABDEVICE_TRANSPORT_BLOCK_POOL
+
+#include "dab/transport/sink.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A sink handing out preallocated, fixed-capacity sample blocks
+   *
+   * The pool allocates all of its blocks up front. A producer reserves a free block, writes its samples
+   * directly into it and commits it, which moves the block into the ready list. The consumer receives ready
+   * blocks as basic_block_pool::block handles, which return their block to the pool when they are destroyed.
+   * Consequently, no memory is allocated and no samples are copied while samples are flowing. Every commit
+   * publishes exactly one block.
+   *
+   * If all blocks are in use, #reserve fails. The producer then either drops its samples, waits for a block via
+   * #wait_for_room, or reclaims the oldest ready block via #discard_oldest (see dab::overflow_policy). Whenever
+   * samples are lost, the next block received by the consumer reports the number of missing samples via
+   * block::discontinuity. Every block also carries the dab::block_metadata last reported via #acquired,
+   * completed with its sequence number, the index of its first sample and its flags.
+   *
+   * @tparam SampleType The type of the samples stored in the blocks
+   *
+   * @since 1.1.0
+   */
+  template<typename SampleType>
+  struct basic_block_pool : basic_sink<SampleType>
+    {
+    using typename basic_sink<SampleType>::sample_type;
+
+    /**
+     * @brief A handle to a ready block
+     *
+     * The handle grants the consumer exclusive access to the samples of a block. Once the handle is
+     * destroyed, or #release is called, the block is returned to the pool it originated from.
+     */
+    struct block
+      {
+      block() = default;
+
+      block(block && other) noexcept
+        : m_pool{other.m_pool},
+          m_index{other.m_index},
+          m_size{other.m_size},
+          m_discontinuity{other.m_discontinuity},
+          m_metadata(other.m_metadata)
+        {
+        other.m_pool = nullptr;
+        }
+
+      block & operator=(block && other) noexcept
+        {
+        if(this != &other)
+          {
+          release();
+          m_pool = other.m_pool;
+          m_index = other.m_index;
+          m_size = other.m_size;
+          m_discontinuity = other.m_discontinuity;
+          m_metadata = other.m_metadata;
+          other.m_pool = nullptr;
+          }
+        return *this;
+        }
+
+      block(block const &) = delete;
+      block & operator=(block const &) = delete;
+
+      ~block()
+        {
+        release();
+        }
+
+      /**
+       * @brief Check whether this handle refers to a block
+       */
+      explicit operator bool() const
+        {
+        return m_pool;
+        }
+
+      sample_type * data()
+        {
+        return m_pool ? m_pool->storage(m_index) : nullptr;
+        }
+
+      sample_type const * data() const
+        {
+        return m_pool ? m_pool->storage(m_index) : nullptr;
+        }
+
+      /**
+       * @brief Get the number of samples in this block
+       */
+      std::size_t size() const
+        {
+        return m_pool ? m_size : 0;
+        }
+
+      bool empty() const
+        {
+        return !size();
+        }
+
+      /**
+       * @brief Get the number of samples that were lost between the previous block and this one
+       *
+       * A value of 0 signals that the samples of this block directly follow those of the previous block.
+       */
+      std::size_t discontinuity() const
+        {
+        return m_pool ? m_discontinuity : 0;
+        }
+
+      /**
+       * @brief Get the center frequency the samples of this block were acquired at
+       *
+       * @return The frequency last reported by the producer, or 0 Hz if the producer never reported one
+       */
+      dab::frequency center_frequency() const
+        {
+        return dab::frequency{m_pool ? m_metadata.centerFrequency : 0};
+        }
+
+      /**
+       * @brief Get the circumstances under which the samples of this block were acquired
+       *
+       * If the producer never reported any via basic_block_pool::acquired, the sample index counts the samples
+       * committed to and lost by the pool, and the timestamp is 0.
+       */
+      block_metadata metadata() const
+        {
+        return m_pool ? m_metadata : block_metadata{};
+        }
+
+      sample_type * begin()
+        {
+        return data();
+        }
+
+      sample_type * end()
+        {
+        return data() + size();
+        }
+
+      sample_type const * begin() const
+        {
+        return data();
+        }
+
+      sample_type const * end() const
+        {
+        return data() + size();
+        }
+
+      sample_type & operator[](std::size_t index)
+        {
+        return data()[index];
+        }
+
+      sample_type const & operator[](std::size_t index) const
+        {
+        return data()[index];
+        }
+
+      /**
+       * @brief Return the block to its pool before the handle is destroyed
+       */
+      void release()
+        {
+        if(m_pool)
+          {
+          m_pool->recycle(m_index);
+          m_pool = nullptr;
+          }
+        }
+
+      private:
+        friend basic_block_pool;
+
+        block(basic_block_pool * pool, std::size_t index, std::size_t size, std::size_t discontinuity,
+              block_metadata const & metadata)
+          : m_pool{pool},
+            m_index{index},
+            m_size{size},
+            m_discontinuity{discontinuity},
+            m_metadata(metadata)
+          {
+
+          }
+
+        basic_block_pool * m_pool{};
+        std::size_t m_index{};
+        std::size_t m_size{};
+        std::size_t m_discontinuity{};
+        block_metadata m_metadata{};
+      };
+
+    /**
+     * @brief Construct a pool of @p nofBlocks blocks, each holding up to @p blockCapacity samples
+     *
+     * @throws std::invalid_argument if either argument is zero
+     */
+    basic_block_pool(std::size_t const nofBlocks, std::size_t const blockCapacity)
+      : m_capacity{blockCapacity},
+        m_storage(nofBlocks * blockCapacity),
+        m_sizes(nofBlocks),
+        m_gaps(nofBlocks),
+        m_metadata(nofBlocks),
+        m_free(nofBlocks),
+        m_ready(nofBlocks)
+      {
+      if(!nofBlocks || !blockCapacity)
+        {
+        throw std::invalid_argument{"A block pool requires at least one block with a capacity of at least one sample."};
+        }
+
+      for(std::size_t index = 0; index < nofBlocks; ++index)
+        {
+        m_free.push(index);
+        }
+      }
+
+    basic_block_pool(basic_block_pool const &) = delete;
+    basic_block_pool & operator=(basic_block_pool const &) = delete;
+
+    sample_type * reserve(std::size_t & count) override
+      {
+      if(!m_reserved)
+        {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if(m_free.empty())
+          {
+          count = 0;
+          return nullptr;
+          }
+
+        m_current = m_free.pop();
+        m_reserved = true;
+        }
+
+      count = std::min(count, m_capacity);
+      return storage(m_current);
+      }
+
+    void commit(std::size_t count) override
+      {
+      if(!m_reserved)
+        {
+        return;
+        }
+
+      m_reserved = false;
+      m_sizes[m_current] = std::min(count, m_capacity);
+
+        {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto & metadata = m_metadata[m_current];
+        metadata = m_pending;
+        metadata.sequence = m_sequence++;
+        metadata.sampleIndex = m_pending.sampleIndex + m_pendingOffset;
+        metadata.flags |= m_pendingGap ? block_metadata::kDiscontinuity : 0;
+        m_pending.flags = 0;
+        m_pendingOffset += m_sizes[m_current];
+        m_gaps[m_current] = m_pendingGap;
+        m_pendingGap = 0;
+        m_ready.push(m_current);
+        m_buffered.store(m_buffered.load(std::memory_order_relaxed) + m_sizes[m_current], std::memory_order_relaxed);
+        }
+
+      m_available.notify_one();
+      }
+
+    /**
+     * @brief Wait for the next ready block
+     */
+    block receive()
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      m_available.wait(lock, [this]{ return !m_ready.empty(); });
+      return take();
+      }
+
+    /**
+     * @brief Get the next ready block, if there is one
+     *
+     * If @p target still refers to a block, that block is returned to the pool first.
+     *
+     * @return @c true iff. a block was available and has been moved into @p target
+     */
+    bool try_receive(block & target)
+      {
+      // A block still held by the target is returned to the pool, which requires the lock
+      target.release();
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if(m_ready.empty())
+        {
+        return false;
+        }
+
+      target = take();
+      return true;
+      }
+
+    /**
+     * @brief Wait for the next ready block for at most @p timeout
+     *
+     * @return @c true iff. a block became available and has been moved into @p target
+     */
+    template<typename Rep, typename Period>
+    bool receive_for(block & target, std::chrono::duration<Rep, Period> const & timeout)
+      {
+      target.release();
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      if(!m_available.wait_for(lock, timeout, [this]{ return !m_ready.empty(); }))
+        {
+        return false;
+        }
+
+      target = take();
+      return true;
+      }
+
+    std::size_t buffered() const override
+      {
+      return m_buffered.load(std::memory_order_relaxed);
+      }
+
+    bool observes_consumer() const override
+      {
+      return true;
+      }
+
+    bool wait_for_room(std::chrono::milliseconds const timeout) override
+      {
+      if(m_reserved)
+        {
+        return true;
+        }
+
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      return m_recycled.wait_for(lock, timeout, [this]{ return !m_free.empty(); });
+      }
+
+    /**
+     * @brief Return the oldest ready block to the free list, discarding its samples
+     */
+    std::size_t discard_oldest() override
+      {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if(m_ready.empty())
+        {
+        return 0;
+        }
+
+      auto const index = m_ready.pop();
+      auto const discarded = m_sizes[index];
+      m_buffered.store(m_buffered.load(std::memory_order_relaxed) - discarded, std::memory_order_relaxed);
+      m_free.push(index);
+
+      // The gap now lies in front of the next ready block, or the next committed one if there is none
+      auto const gap = m_gaps[index] + discarded;
+      if(m_ready.empty())
+        {
+        m_pendingGap += gap;
+        }
+      else
+        {
+        m_gaps[m_ready.front()] += gap;
+        m_metadata[m_ready.front()].flags |= block_metadata::kDiscontinuity;
+        }
+
+      return discarded;
+      }
+
+    void discontinuity(std::size_t const count) override
+      {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_pendingGap += count;
+      m_pendingOffset += count;
+      }
+
+    void retuned(dab::frequency const centerFrequency) override
+      {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_pending.centerFrequency = static_cast<std::uint32_t>(centerFrequency);
+      m_pending.flags |= block_metadata::kRetuned;
+      }
+
+    void acquired(block_metadata const & metadata) override
+      {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_pending = metadata;
+      m_pendingOffset = 0;
+      }
+
+    /**
+     * @brief Get the number of samples a single block can hold
+     */
+    std::size_t block_capacity() const
+      {
+      return m_capacity;
+      }
+
+    /**
+     * @brief Get the number of blocks managed by this pool
+     */
+    std::size_t size() const
+      {
+      return m_sizes.size();
+      }
+
+    /**
+     * @brief Get the number of blocks that are currently free
+     */
+    std::size_t available() const
+      {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      return m_free.size();
+      }
+
+    private:
+      /**
+       * @internal
+       *
+       * @brief A fixed-capacity FIFO of block indices
+       *
+       * Since a pool never manages more than its initial number of blocks, the FIFOs never need to grow.
+       */
+      struct index_fifo
+        {
+        explicit index_fifo(std::size_t capacity)
+          : m_indices(capacity)
+          {
+
+          }
+
+        void push(std::size_t index)
+          {
+          m_indices[(m_head + m_size++) % m_indices.size()] = index;
+          }
+
+        std::size_t front() const
+          {
+          return m_indices[m_head];
+          }
+
+        std::size_t pop()
+          {
+          auto const index = m_indices[m_head];
+          m_head = (m_head + 1) % m_indices.size();
+          --m_size;
+          return index;
+          }
+
+        bool empty() const
+          {
+          return !m_size;
+          }
+
+        std::size_t size() const
+          {
+          return m_size;
+          }
+
+        private:
+          std::vector<std::size_t> m_indices;
+          std::size_t m_head{};
+          std::size_t m_size{};
+        };
+
+      sample_type * storage(std::size_t index)
+        {
+        return m_storage.data() + index * m_capacity;
+        }
+
+      sample_type const * storage(std::size_t index) const
+        {
+        return m_storage.data() + index * m_capacity;
+        }
+
+      block take()
+        {
+        auto const index = m_ready.pop();
+        m_buffered.store(m_buffered.load(std::memory_order_relaxed) - m_sizes[index], std::memory_order_relaxed);
+        return block{this, index, m_sizes[index], m_gaps[index], m_metadata[index]};
+        }
+
+      void recycle(std::size_t index)
+        {
+          {
+          std::lock_guard<std::mutex> lock{m_mutex};
+          m_free.push(index);
+          }
+
+        m_recycled.notify_one();
+        }
+
+      std::size_t const m_capacity;
+      std::vector<sample_type> m_storage;
+      std::vector<std::size_t> m_sizes;
+      std::vector<std::size_t> m_gaps;
+      std::vector<block_metadata> m_metadata;
+      index_fifo m_free;
+      index_fifo m_ready;
+      std::size_t m_current{};
+      std::size_t m_pendingGap{};
+      block_metadata m_pending{};
+      std::uint64_t m_pendingOffset{};
+      std::uint64_t m_sequence{};
+      bool m_reserved{};
+      std::atomic<std::size_t> m_buffered{};
+      mutable std::mutex m_mutex{};
+      std::condition_variable m_available{};
+      std::condition_variable m_recycled{};
+    };
+
+  /**
+   * @brief Convenience alias for pools of complex floating-point sample blocks
+   *
+   * @since 1.1.0
+   */
+  using sample_block_pool = basic_block_pool<internal::sample_t>;
+
+  /**
+   * @brief Convenience alias for pools of raw I/Q pairs
+   *
+   * @since 1.1.0
+   */
+  using raw_block_pool = basic_block_pool<raw_sample>;
+
+  /**
+   * @brief Convenience alias for pools of Q15 fixed-point sample blocks
+   *
+   * @since 1.1.0
+   */
+  using fixed_block_pool = basic_block_pool<fixed_sample>;
+
+  }
+
+#endif
@@ -0,0 +1,453 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TRANSPORT_RAW_RECORDER
+#define DABDEVICE_TRANSPORT_RAW_RECORDER
+
+#include "dab/transport/spsc_ring.h"
+#include "dab/transport/wait_strategy.h"
+#include "dab/types/raw_sample.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace dab
+  {
+
+  /**
+   * @brief The configuration of a dab::raw_recorder
+   *
+   * @since 1.1.0
+   */
+  struct recording_options
+    {
+    /**
+     * @brief The alignment of the write buffer, and the granularity of all writes except the last one
+     */
+    static std::size_t constexpr kAlignment = 4096;
+
+    /**
+     * @brief Construct the options for recordings into files starting with @p prefix
+     *
+     * The recorded files are named <prefix>-<sequence number>.raw, where the sequence number starts at 0 and
+     * is padded to six digits.
+     */
+    explicit recording_options(std::string prefix)
+      : prefix{std::move(prefix)}
+      {
+
+      }
+
+    /**
+     * @brief The path prefix of the recorded files
+     */
+    std::string prefix;
+
+    /**
+     * @brief Start a new file before a file would grow beyond this number of bytes, 0 disables the limit
+     */
+    std::uint64_t maxFileSize{};
+
+    /**
+     * @brief Start a new file once a file has been written to for this long, 0 disables the limit
+     */
+    std::chrono::seconds maxFileAge{};
+
+    /**
+     * @brief Bypass the page cache using @c O_DIRECT, if supported by the file system
+     */
+    bool directIo{};
+
+    /**
+     * @brief The number of bytes buffered between the producer and the writer thread
+     *
+     * The default buffers 16 seconds of samples at 2.048 MSps.
+     */
+    std::size_t bufferSize{64 * 1024 * 1024};
+
+    /**
+     * @brief The number of bytes written to disk at once, must be a non-zero multiple of #kAlignment
+     */
+    std::size_t writeSize{4 * 1024 * 1024};
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief The wait strategy of the ring between #raw_recorder::record and the writer thread
+     *
+     * Notifying must never acquire a lock, since #raw_recorder::record runs on the acquisition thread of the
+     * device. On Linux, waking the writer costs a single futex system call. Elsewhere, the writer polls the
+     * ring, which the producer does not notice at all.
+     */
+#if defined(__linux__)
+    using recorder_wait = futex_wait;
+#else
+    using recorder_wait = poll_wait;
+#endif
+
+    }
+
+  /**
+   * @brief Asynchronously archive raw samples into a series of files
+   *
+   * The producer hands raw bytes to #record, which copies them into a lock-free ring and returns immediately.
+   * A background thread drains the ring into a page-aligned buffer and writes the buffer to disk once it is
+   * full. If the disk cannot keep up and the ring fills up, #record drops the bytes that do not fit and
+   * accounts for them in #dropped, so the producer is never blocked by the disk.
+   *
+   * @note #record must only ever be called by a single thread at a time.
+   *
+   * @since 1.1.0
+   */
+  struct raw_recorder
+    {
+    /**
+     * @brief Open the first file and start the writer thread
+     *
+     * @throws std::invalid_argument if the buffer or write size is invalid
+     * @throws std::system_error if the first file cannot be opened
+     */
+    explicit raw_recorder(recording_options options)
+      : m_options{validate(std::move(options))},
+        m_ring{m_options.bufferSize / sizeof(raw_sample)}
+      {
+      void * buffer{};
+      if(posix_memalign(&buffer, recording_options::kAlignment, m_options.writeSize))
+        {
+        throw std::bad_alloc{};
+        }
+      m_buffer = static_cast<raw_sample *>(buffer);
+
+      try
+        {
+        open();
+        }
+      catch(...)
+        {
+        std::free(m_buffer);
+        throw;
+        }
+
+      m_writer = std::thread{[this]{ drain(); }};
+      }
+
+    raw_recorder(raw_recorder const &) = delete;
+    raw_recorder & operator=(raw_recorder const &) = delete;
+
+    /**
+     * @brief Write all buffered bytes to disk and stop the writer thread
+     */
+    ~raw_recorder()
+      {
+      m_ring.close();
+      m_writer.join();
+      std::free(m_buffer);
+      }
+
+    /**
+     * @brief Queue @p length raw bytes starting at @p raw for recording
+     *
+     * This function never blocks and never acquires a lock, so it is safe to call from the USB callback of a
+     * device. Bytes that do not fit into the buffer are dropped.
+     */
+    void record(std::uint8_t const * raw, std::size_t length)
+      {
+      auto const nofSamples = length / sizeof(raw_sample);
+      auto queued = std::size_t{};
+      while(queued < nofSamples)
+        {
+        auto count = nofSamples - queued;
+        auto const target = m_ring.reserve(count);
+        if(!target)
+          {
+          break;
+          }
+
+        std::copy_n(reinterpret_cast<raw_sample const *>(raw) + queued, count, target);
+        m_ring.commit(count);
+        queued += count;
+        }
+
+      if(queued < nofSamples)
+        {
+        m_dropped.fetch_add((nofSamples - queued) * sizeof(raw_sample), std::memory_order_relaxed);
+        }
+      }
+
+    /**
+     * @brief Get the number of bytes written to disk so far
+     */
+    std::uint64_t recorded() const
+      {
+      return m_recorded.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the number of bytes dropped because the writer could not keep up or failed
+     */
+    std::uint64_t dropped() const
+      {
+      return m_dropped.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the number of files opened so far
+     */
+    std::size_t files() const
+      {
+      return m_files.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the error that stopped the writer, if any
+     *
+     * Once writing failed, the writer discards all further bytes and accounts for them in #dropped.
+     */
+    std::error_code error() const
+      {
+      return std::error_code{m_error.load(std::memory_order_relaxed), std::generic_category()};
+      }
+
+    /**
+     * @brief Get the name of the file with the given sequence number
+     */
+    std::string filename(std::size_t sequence) const
+      {
+      char suffix[16];
+      std::snprintf(suffix, sizeof(suffix), "-%06zu.raw", sequence);
+      return m_options.prefix + suffix;
+      }
+
+    private:
+      static recording_options validate(recording_options options)
+        {
+        if(!options.writeSize || options.writeSize % recording_options::kAlignment)
+          {
+          throw std::invalid_argument{"The write size must be a non-zero multiple of the alignment."};
+          }
+
+        if(options.bufferSize < options.writeSize)
+          {
+          throw std::invalid_argument{"The buffer must be able to hold at least one write."};
+          }
+
+        return options;
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Open the next file in the sequence
+       *
+       * If the file system does not support @c O_DIRECT, the file is opened for regular buffered writes.
+       */
+      void open()
+        {
+        auto const name = filename(m_files.load(std::memory_order_relaxed));
+        auto flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#if defined(O_DIRECT)
+        if(m_options.directIo)
+          {
+          m_descriptor = ::open(name.c_str(), flags | O_DIRECT, 0644);
+          }
+
+        if(m_descriptor < 0)
+#endif
+          {
+          m_descriptor = ::open(name.c_str(), flags, 0644);
+          }
+
+        if(m_descriptor < 0)
+          {
+          throw std::system_error{errno, std::generic_category(), "Failed to open '" + name + "'"};
+          }
+
+        m_files.fetch_add(1, std::memory_order_relaxed);
+        m_fileSize = 0;
+        m_opened = std::chrono::steady_clock::now();
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Close the current file
+       */
+      void close()
+        {
+        if(m_descriptor >= 0)
+          {
+          ::close(m_descriptor);
+          m_descriptor = -1;
+          }
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Start a new file if the current one would exceed its size or age limit
+       */
+      void rotate(std::size_t nextWrite)
+        {
+        auto const tooLarge = m_options.maxFileSize && m_fileSize && m_fileSize + nextWrite > m_options.maxFileSize;
+        auto const tooOld = m_options.maxFileAge.count() && std::chrono::steady_clock::now() - m_opened >= m_options.maxFileAge;
+
+        if(tooLarge || tooOld)
+          {
+          close();
+          open();
+          }
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Write the first @p length bytes of the write buffer to the current file
+       */
+      void write(std::size_t length)
+        {
+        rotate(length);
+
+#if defined(O_DIRECT)
+        if(length % recording_options::kAlignment)
+          {
+          ::fcntl(m_descriptor, F_SETFL, ::fcntl(m_descriptor, F_GETFL) & ~O_DIRECT);
+          }
+#endif
+
+        auto const bytes = reinterpret_cast<char const *>(m_buffer);
+        auto offset = std::size_t{};
+        while(offset < length)
+          {
+          auto const written = ::write(m_descriptor, bytes + offset, length - offset);
+          if(written < 0)
+            {
+            if(errno == EINTR)
+              {
+              continue;
+              }
+            throw std::system_error{errno, std::generic_category(), "Failed to write recording"};
+            }
+          offset += written;
+          }
+
+        m_fileSize += length;
+        m_recorded.fetch_add(length, std::memory_order_relaxed);
+        }
+
+      /**
+       * @internal
+       *
+       * @brief The body of the writer thread
+       */
+      void drain()
+        {
+        auto const capacity = m_options.writeSize / sizeof(raw_sample);
+        auto fill = std::size_t{};
+
+        while(auto const count = m_ring.read(m_buffer + fill, capacity - fill))
+          {
+          if(m_error.load(std::memory_order_relaxed))
+            {
+            m_dropped.fetch_add(count * sizeof(raw_sample), std::memory_order_relaxed);
+            continue;
+            }
+
+          fill += count;
+          if(fill == capacity)
+            {
+            fill = 0;
+            flush(m_options.writeSize);
+            }
+          }
+
+        if(fill && !m_error.load(std::memory_order_relaxed))
+          {
+          flush(fill * sizeof(raw_sample));
+          }
+
+        close();
+        }
+
+      /**
+       * @internal
+       *
+       * @brief Write @p length bytes, turning failures into a sticky error
+       */
+      void flush(std::size_t length)
+        {
+        try
+          {
+          write(length);
+          }
+        catch(std::system_error const & error)
+          {
+          m_error.store(error.code().value(), std::memory_order_relaxed);
+          m_dropped.fetch_add(length, std::memory_order_relaxed);
+          }
+        }
+
+      recording_options const m_options;
+      basic_spsc_ring<raw_sample, internal::recorder_wait> m_ring;
+      raw_sample * m_buffer{};
+      int m_descriptor{-1};
+      std::uint64_t m_fileSize{};
+      std::chrono::steady_clock::time_point m_opened{};
+      std::atomic<std::uint64_t> m_recorded{};
+      std::atomic<std::uint64_t> m_dropped{};
+      std::atomic<std::size_t> m_files{};
+      std::atomic<int> m_error{};
+      std::thread m_writer{};
+    };
+
+  }
+
+#endif
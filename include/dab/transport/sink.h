@@ -0,0 +1,443 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TRANSPORT_SINK
+#define DABDEVICE_TRANSPORT_SINK
+
+#include "dab/types/block_metadata.h"
+#include "dab/types/fixed_sample.h"
+#include "dab/types/frequency.h"
+#include "dab/types/raw_sample.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The formats in which devices can deliver samples
+   *
+   * @since 1.1.0
+   */
+  enum struct sample_format : std::uint8_t
+    {
+    /**
+     * @brief Complex floating-point samples (dab::internal::sample_t)
+     *
+     * Both components are scaled to lie between -1.0f and 1.0f.
+     */
+    complex_float,
+
+    /**
+     * @brief Raw interleaved unsigned 8-bit I/Q pairs (dab::raw_sample)
+     *
+     * The samples are delivered exactly as produced by the hardware, without normalization or calibration.
+     */
+    raw_uint8,
+
+    /**
+     * @brief Complex Q15 fixed-point samples (dab::fixed_sample)
+     *
+     * Both components are scaled to lie between -32768 and 32767.
+     */
+    complex_int16,
+    };
+
+  /**
+   * @brief Map a sample type to its dab::sample_format
+   *
+   * @since 1.1.0
+   */
+  template<typename SampleType>
+  struct sample_format_of;
+
+  template<>
+  struct sample_format_of<internal::sample_t>
+    {
+    static sample_format constexpr value = sample_format::complex_float;
+    };
+
+  template<>
+  struct sample_format_of<raw_sample>
+    {
+    static sample_format constexpr value = sample_format::raw_uint8;
+    };
+
+  template<>
+  struct sample_format_of<fixed_sample>
+    {
+    static sample_format constexpr value = sample_format::complex_int16;
+    };
+
+  /**
+   * @brief What a device does with new samples when its sink is full
+   *
+   * @see dab::device::overflow
+   * @since 1.1.0
+   */
+  enum struct overflow_policy : std::uint8_t
+    {
+    /**
+     * @brief Wait until the consumer makes room
+     *
+     * No samples are lost, but the producer is throttled to the pace of the consumer. This is the right
+     * choice for recordings, but stalls the acquisition of live devices.
+     */
+    block,
+
+    /**
+     * @brief Drop the samples that do not fit into the sink
+     *
+     * The consumer keeps receiving the samples it fell behind on.
+     */
+    drop_newest,
+
+    /**
+     * @brief Discard the oldest samples buffered in the sink to make room for the new ones
+     *
+     * The consumer skips ahead to the most recent samples, which is usually the right choice for live
+     * devices. Sinks that cannot discard buffered samples drop the new samples instead.
+     */
+    drop_oldest,
+    };
+
+  /**
+   * @brief Get the size of a single sample of the given format in bytes
+   *
+   * @since 1.1.0
+   */
+  inline std::size_t sample_size(sample_format const format)
+    {
+    switch(format)
+      {
+      case sample_format::raw_uint8:
+        return sizeof(raw_sample);
+      case sample_format::complex_int16:
+        return sizeof(fixed_sample);
+      default:
+        return sizeof(internal::sample_t);
+      }
+    }
+
+  /**
+   * @brief The format-neutral base of all sample destinations
+   *
+   * Devices publish the samples they acquire into a sink. The concrete sink type determines how samples
+   * are transported to the consumer, while its #format determines which representation the device has to
+   * produce. Device implementations check the format and then address the sink through the matching
+   * dab::basic_sink.
+   *
+   * @since 1.1.0
+   */
+  struct sink
+    {
+    virtual ~sink() = default;
+
+    /**
+     * @brief Get the format of the samples accepted by this sink
+     */
+    virtual sample_format format() const = 0;
+
+    /**
+     * @brief Get the number of samples that have been committed, but not yet taken by the consumer
+     *
+     * The result is a momentary estimate, intended for monitoring. Sinks that cannot observe their consumer,
+     * like dab::queue_sink, report 0 (see #observes_consumer).
+     */
+    virtual std::size_t buffered() const
+      {
+      return 0;
+      }
+
+    /**
+     * @brief Check whether the sink knows how many samples its consumer has not taken yet
+     *
+     * Only if this function returns @c true, #buffered reports the actual number of buffered samples. Sinks
+     * that cannot observe their consumer, like dab::queue_sink, return @c false.
+     */
+    virtual bool observes_consumer() const
+      {
+      return false;
+      }
+
+    /**
+     * @brief Wait for at most @p timeout until there is room for new samples
+     *
+     * Producers call this function to implement dab::overflow_policy::block. Sinks that cannot be notified
+     * when the consumer makes room simply sleep for @p timeout.
+     *
+     * @return @c true if there is room for at least one sample
+     */
+    virtual bool wait_for_room(std::chrono::milliseconds const timeout)
+      {
+      std::this_thread::sleep_for(timeout);
+      return false;
+      }
+
+    /**
+     * @brief Discard the oldest samples that have not been taken by the consumer yet
+     *
+     * Producers call this function to implement dab::overflow_policy::drop_oldest. The consumer is informed
+     * about the gap in the same way as by #discontinuity.
+     *
+     * @return The number of samples that were discarded. Sinks that cannot discard buffered samples return 0.
+     */
+    virtual std::size_t discard_oldest()
+      {
+      return 0;
+      }
+
+    /**
+     * @brief Inform the consumer that @p count samples are missing before the next committed samples
+     *
+     * Sinks that can attach information to the samples they transport pass it on to the consumer. All
+     * other sinks ignore it.
+     */
+    virtual void discontinuity(std::size_t const count)
+      {
+      static_cast<void>(count);
+      }
+
+    /**
+     * @brief Inform the consumer that the next committed samples were acquired at @p centerFrequency
+     *
+     * Devices that retune on their acquisition thread, like a hopping dab::rtl_device, call this function before
+     * committing the first samples acquired at the new frequency. Sinks that can attach information to the
+     * samples they transport pass it on to the consumer. All other sinks ignore it.
+     */
+    virtual void retuned(frequency const centerFrequency)
+      {
+      static_cast<void>(centerFrequency);
+      }
+
+    /**
+     * @brief Inform the consumer about the acquisition of the next committed samples
+     *
+     * Devices call this function on their acquisition thread right before delivering a block of raw samples.
+     * The sequence number of @p metadata is left for the sink to assign. Sinks that can attach information to
+     * the samples they transport pass it on to the consumer. All other sinks ignore it.
+     */
+    virtual void acquired(block_metadata const & metadata)
+      {
+      static_cast<void>(metadata);
+      }
+    };
+
+  /**
+   * @brief A sink accepting samples of type @p SampleType
+   *
+   * Producers publish samples in two steps. First, they #reserve room for a number of samples and write the
+   * samples directly into the returned storage. Afterwards, they #commit the number of samples actually
+   * written, making them available to the consumer. This scheme allows devices to convert their raw samples
+   * directly into the memory of the transport, without intermediate copies.
+   *
+   * A sink is used by exactly one producer.
+   *
+   * @since 1.1.0
+   */
+  template<typename SampleType>
+  struct basic_sink : sink
+    {
+    /**
+     * @brief The type of the samples accepted by this sink
+     */
+    using sample_type = SampleType;
+
+    sample_format format() const override
+      {
+      return sample_format_of<SampleType>::value;
+      }
+
+    /**
+     * @brief Reserve room for up to @p count samples
+     *
+     * @param count The number of samples to reserve room for. On return, it contains the number of samples
+     * that fit into the returned storage, which might be less than requested.
+     *
+     * @return A pointer to contiguous storage for @p count samples, or @c nullptr if the sink cannot accept
+     * any samples at the moment. In the latter case, @p count is set to 0.
+     */
+    virtual sample_type * reserve(std::size_t & count) = 0;
+
+    /**
+     * @brief Publish the first @p count samples of the last reservation
+     */
+    virtual void commit(std::size_t count) = 0;
+
+    /**
+     * @brief Copy @p count samples into the sink
+     *
+     * @return The number of samples that were accepted by the sink
+     */
+    std::size_t write(sample_type const * samples, std::size_t count)
+      {
+      auto written = std::size_t{};
+      while(written < count)
+        {
+        auto reserved = count - written;
+        auto const target = reserve(reserved);
+        if(!target)
+          {
+          break;
+          }
+
+        std::copy(samples + written, samples + written + reserved, target);
+        commit(reserved);
+        written += reserved;
+        }
+
+      return written;
+      }
+    };
+
+  /**
+   * @brief Convenience alias for sinks accepting complex floating-point samples
+   *
+   * @since 1.1.0
+   */
+  using sample_sink = basic_sink<internal::sample_t>;
+
+  /**
+   * @brief Convenience alias for sinks accepting raw I/Q pairs
+   *
+   * @since 1.1.0
+   */
+  using raw_sink = basic_sink<raw_sample>;
+
+  /**
+   * @brief Convenience alias for sinks accepting Q15 fixed-point samples
+   *
+   * @since 1.1.0
+   */
+  using fixed_sink = basic_sink<fixed_sample>;
+
+  /**
+   * @brief A sink feeding a dab::sample_queue_t
+   *
+   * This sink provides the transport used by devices constructed from a dab::sample_queue_t. Since the queue
+   * stores samples individually, every committed block is copied into the queue. The queue grows without
+   * bounds, so the sink never rejects samples and no gaps ever have to be reported to its consumer.
+   *
+   * @since 1.1.0
+   */
+  struct queue_sink : sample_sink
+    {
+    /**
+     * @brief Construct a sink feeding the given queue
+     *
+     * The caller must guarantee that the queue outlives the sink.
+     */
+    explicit queue_sink(sample_queue_t & queue)
+      : m_queue{queue}
+      {
+
+      }
+
+    sample_type * reserve(std::size_t & count) override
+      {
+      m_buffer.resize(count);
+      return m_buffer.data();
+      }
+
+    void commit(std::size_t count) override
+      {
+      m_buffer.resize(count);
+      m_queue.enqueue(m_buffer);
+      }
+
+    private:
+      sample_queue_t & m_queue;
+      std::vector<sample_type> m_buffer{};
+    };
+
+  /**
+   * @brief A sink converting samples straight into storage provided by the caller
+   *
+   * The sink accepts samples until the storage is full and rejects further samples. It is used by
+   * dab::device::read to deliver samples without an intermediate transport.
+   *
+   * @since 1.1.0
+   */
+  template<typename SampleType>
+  struct basic_buffer_sink : basic_sink<SampleType>
+    {
+    using sample_type = SampleType;
+
+    /**
+     * @brief Construct a sink filling the @p capacity samples starting at @p storage
+     */
+    basic_buffer_sink(sample_type * storage, std::size_t const capacity)
+      : m_storage{storage},
+        m_capacity{capacity}
+      {
+
+      }
+
+    sample_type * reserve(std::size_t & count) override
+      {
+      if(m_size == m_capacity)
+        {
+        return nullptr;
+        }
+
+      count = std::min(count, m_capacity - m_size);
+      return m_storage + m_size;
+      }
+
+    void commit(std::size_t count) override
+      {
+      m_size += count;
+      }
+
+    /**
+     * @brief Get the number of samples written into the storage so far
+     */
+    std::size_t size() const
+      {
+      return m_size;
+      }
+
+    private:
+      sample_type * const m_storage;
+      std::size_t const m_capacity;
+      std::size_t m_size{};
+    };
+
+  }
+
+#endif
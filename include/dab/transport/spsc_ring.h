@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TRANSPORT_SPSC_RING
+#define DABDEVICE_TRANSPORT_SPSC_RING
+
+#include "dab/transport/sink.h"
+#include "dab/transport/wait_strategy.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A bounded, lock-free sink for exactly one producer and one consumer
+   *
+   * The ring provides contiguous storage for a power-of-two number of samples. The producer converts its
+   * samples directly into the ring via #reserve and #commit, while the consumer copies out batches of samples
+   * using #read. Neither side ever acquires a lock while samples are flowing. Reservations never wrap around
+   * the end of the ring, so a reservation might be shorter than the free space in the ring.
+   *
+   * If the ring is full, #reserve fails and the producer has to drop its samples. The producer reports the gap
+   * via #discontinuity, and a #read never spans a gap, so the consumer learns how many samples were lost right
+   * before the samples of a read from #last_discontinuity. The ring cannot discard samples the consumer has not
+   * read yet, so dab::overflow_policy::drop_oldest drops the new samples instead. The consumer blocks according
+   * to the @p WaitStrategy until samples are available or the ring has been closed.
+   *
+   * @tparam SampleType The type of the samples stored in the ring
+   * @tparam WaitStrategy The strategy used by the consumer to wait for samples (see dab::spin_wait)
+   *
+   * @since 1.1.0
+   */
+  template<typename SampleType, typename WaitStrategy = spin_then_park_wait>
+  struct basic_spsc_ring : basic_sink<SampleType>
+    {
+    using typename basic_sink<SampleType>::sample_type;
+
+    /**
+     * @brief Construct a ring holding at least @p capacity samples
+     *
+     * The capacity is rounded up to the next power of two.
+     *
+     * @throws std::invalid_argument if @p capacity is zero
+     */
+    explicit basic_spsc_ring(std::size_t const capacity)
+      : m_storage(round_up(capacity)),
+        m_mask{m_storage.size() - 1}
+      {
+
+      }
+
+    basic_spsc_ring(basic_spsc_ring const &) = delete;
+    basic_spsc_ring & operator=(basic_spsc_ring const &) = delete;
+
+    sample_type * reserve(std::size_t & count) override
+      {
+      auto const tail = m_producer.index.load(std::memory_order_relaxed);
+      auto space = capacity() - (tail - m_producer.cached);
+
+      if(space < count)
+        {
+        m_producer.cached = m_consumer.index.load(std::memory_order_acquire);
+        space = capacity() - (tail - m_producer.cached);
+        }
+
+      if(!space)
+        {
+        count = 0;
+        return nullptr;
+        }
+
+      auto const offset = tail & m_mask;
+      count = std::min(count, std::min(space, capacity() - offset));
+      return m_storage.data() + offset;
+      }
+
+    void commit(std::size_t count) override
+      {
+      auto const tail = m_producer.index.load(std::memory_order_relaxed);
+      m_producer.index.store(tail + count, std::memory_order_release);
+      m_wait.notify();
+      }
+
+    /**
+     * @brief Record that @p count samples are missing before the next committed samples
+     *
+     * Up to #kGapCapacity gaps can be pending at a time. While the consumer has not caught up on them, further
+     * gaps are merged and reported with the next read, regardless of where they occurred.
+     */
+    void discontinuity(std::size_t const count) override
+      {
+      auto const tail = m_gapTail.load(std::memory_order_relaxed);
+      if(tail - m_gapHead.load(std::memory_order_acquire) == kGapCapacity)
+        {
+        m_excessGaps.fetch_add(count, std::memory_order_relaxed);
+        return;
+        }
+
+      m_gaps[tail & (kGapCapacity - 1)] = gap{m_producer.index.load(std::memory_order_relaxed), count};
+      m_gapTail.store(tail + 1, std::memory_order_release);
+      }
+
+    /**
+     * @brief Wait for samples and copy up to @p count of them into @p target
+     *
+     * @return The number of samples copied into @p target. A return value of 0 signals that the ring has been
+     * closed and all samples have been read. The samples copied by a single read directly follow each other.
+     */
+    std::size_t read(sample_type * target, std::size_t count)
+      {
+      m_wait.wait([this]{
+        return readable() || m_closed.load(std::memory_order_acquire);
+      });
+
+      return try_read(target, count);
+      }
+
+    /**
+     * @brief Copy up to @p count of the available samples into @p target without waiting
+     *
+     * @return The number of samples copied into @p target
+     */
+    std::size_t try_read(sample_type * target, std::size_t count)
+      {
+      auto const head = m_consumer.index.load(std::memory_order_relaxed);
+      count = std::min(count, readable());
+
+      // Gaps published after the samples they precede were read are reported with the next read
+      m_discontinuity = 0;
+      while(m_gapHead.load(std::memory_order_relaxed) != m_gapTail.load(std::memory_order_acquire))
+        {
+        auto const & next = m_gaps[m_gapHead.load(std::memory_order_relaxed) & (kGapCapacity - 1)];
+        if(next.position > head)
+          {
+          count = std::min(count, next.position - head);
+          break;
+          }
+
+        m_discontinuity += next.count;
+        m_gapHead.store(m_gapHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+      if(m_excessGaps.load(std::memory_order_relaxed))
+        {
+        m_discontinuity += m_excessGaps.exchange(0, std::memory_order_relaxed);
+        }
+
+      auto const offset = head & m_mask;
+      auto const first = std::min(count, capacity() - offset);
+      std::copy_n(m_storage.data() + offset, first, target);
+      std::copy_n(m_storage.data(), count - first, target + first);
+
+      m_consumer.index.store(head + count, std::memory_order_release);
+      return count;
+      }
+
+    /**
+     * @brief Get the number of samples that were lost right before the samples returned by the last read
+     *
+     * A value of 0 signals that the samples of the last read directly follow those of the previous read. This
+     * function must only be called by the consumer.
+     */
+    std::size_t last_discontinuity() const
+      {
+      return m_discontinuity;
+      }
+
+    /**
+     * @brief Signal the consumer that no more samples will be committed
+     *
+     * Once the remaining samples have been read, #read returns 0 instead of waiting.
+     */
+    void close()
+      {
+      m_closed.store(true, std::memory_order_release);
+      m_wait.notify();
+      }
+
+    /**
+     * @brief Get the number of samples the ring can hold
+     */
+    std::size_t capacity() const
+      {
+      return m_storage.size();
+      }
+
+    std::size_t buffered() const override
+      {
+      return m_producer.index.load(std::memory_order_relaxed) - m_consumer.index.load(std::memory_order_relaxed);
+      }
+
+    bool observes_consumer() const override
+      {
+      return true;
+      }
+
+    /**
+     * @brief Wait for the consumer to make room by polling the index of the consumer
+     *
+     * Since the consumer never blocks on the producer, it does not notify the producer either.
+     */
+    bool wait_for_room(std::chrono::milliseconds const timeout) override
+      {
+      auto const deadline = std::chrono::steady_clock::now() + timeout;
+      while(m_producer.index.load(std::memory_order_relaxed) - m_consumer.index.load(std::memory_order_acquire) == capacity())
+        {
+        if(std::chrono::steady_clock::now() >= deadline)
+          {
+          return false;
+          }
+        std::this_thread::yield();
+        }
+
+      return true;
+      }
+
+    /**
+     * @brief Get the number of samples that are currently available to the consumer
+     *
+     * This function must only be called by the consumer.
+     */
+    std::size_t readable() const
+      {
+      return m_producer.index.load(std::memory_order_acquire) - m_consumer.index.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief The number of gaps that can be pending before further gaps are merged
+     */
+    static std::size_t constexpr kGapCapacity = 64;
+
+    private:
+      static std::size_t constexpr kCacheLineSize = 64;
+
+      /**
+       * @internal
+       *
+       * @brief A run of @p count lost samples, right before the sample at index @p position
+       */
+      struct gap
+        {
+        std::size_t position;
+        std::size_t count;
+        };
+
+      /**
+       * @internal
+       *
+       * @brief The index owned by one side of the ring, padded to fill a cache line of its own
+       *
+       * The member @p cached holds the last value of the opposite index seen by the owning side. It allows
+       * the producer to reserve storage without touching the cache line of the consumer on every call.
+       */
+      struct side
+        {
+        std::atomic<std::size_t> index{};
+        std::size_t cached{};
+        char padding[kCacheLineSize - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+        };
+
+      static std::size_t round_up(std::size_t capacity)
+        {
+        if(!capacity)
+          {
+          throw std::invalid_argument{"A ring requires a capacity of at least one sample."};
+          }
+
+        auto rounded = std::size_t{1};
+        while(rounded < capacity)
+          {
+          rounded <<= 1;
+          }
+
+        return rounded;
+        }
+
+      std::vector<sample_type> m_storage;
+      std::size_t const m_mask;
+      char m_padding[kCacheLineSize]{};
+      side m_producer{};
+      side m_consumer{};
+      std::atomic<bool> m_closed{};
+      WaitStrategy m_wait{};
+      gap m_gaps[kGapCapacity]{};
+      std::atomic<std::size_t> m_gapTail{};
+      std::atomic<std::size_t> m_gapHead{};
+      std::atomic<std::size_t> m_excessGaps{};
+      std::size_t m_discontinuity{};
+    };
+
+  /**
+   * @brief Convenience alias for rings of complex floating-point samples
+   *
+   * @since 1.1.0
+   */
+  using sample_ring = basic_spsc_ring<internal::sample_t>;
+
+  /**
+   * @brief Convenience alias for rings of raw I/Q pairs
+   *
+   * @since 1.1.0
+   */
+  using raw_ring = basic_spsc_ring<raw_sample>;
+
+  /**
+   * @brief Convenience alias for rings of Q15 fixed-point samples
+   *
+   * @since 1.1.0
+   */
+  using fixed_ring = basic_spsc_ring<fixed_sample>;
+
+  }
+
+#endif
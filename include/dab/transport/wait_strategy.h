@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TRANSPORT_WAIT_STRATEGY
+#define DABDEVICE_TRANSPORT_WAIT_STRATEGY
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief Hint the CPU that the calling thread is busy-waiting
+     */
+    inline void cpu_relax()
+      {
+#if defined(__i386__) || defined(__x86_64__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      __asm__ __volatile__("yield");
+#endif
+      }
+
+    }
+
+  /**
+   * @brief A wait strategy that never gives up the CPU
+   *
+   * Waiting consumers poll the condition in a tight loop. This strategy provides the lowest wake-up latency
+   * at the cost of keeping one core busy, and should only be used when the consumer runs on a dedicated core.
+   * Notifying is free.
+   *
+   * All wait strategies provide the same interface: @c wait(ready) blocks until the predicate @c ready
+   * returns @c true, while @c notify() wakes a waiting thread after the condition might have changed. Each
+   * strategy supports exactly one waiting thread and one notifying thread.
+   *
+   * @since 1.1.0
+   */
+  struct spin_wait
+    {
+    template<typename Predicate>
+    void wait(Predicate ready)
+      {
+      while(!ready())
+        {
+        internal::cpu_relax();
+        }
+      }
+
+    void notify()
+      {
+
+      }
+    };
+
+  /**
+   * @brief A wait strategy that spins for a short time before parking the waiting thread
+   *
+   * Waiting consumers poll the condition #kSpinCount times, before they block on a condition variable. The
+   * notifying thread only acquires the mutex if a consumer is actually parked, so the producer does not pay
+   * for the condition variable as long as the consumer keeps up.
+   *
+   * @since 1.1.0
+   */
+  struct spin_then_park_wait
+    {
+    /**
+     * @brief The number of times the condition is polled before the waiting thread is parked
+     */
+    static std::size_t constexpr kSpinCount = 4096;
+
+    template<typename Predicate>
+    void wait(Predicate ready)
+      {
+      for(std::size_t spin = 0; spin < kSpinCount; ++spin)
+        {
+        if(ready())
+          {
+          return;
+          }
+        internal::cpu_relax();
+        }
+
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      m_parked.store(true, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      m_wakeup.wait(lock, ready);
+      m_parked.store(false, std::memory_order_relaxed);
+      }
+
+    void notify()
+      {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(m_parked.load(std::memory_order_seq_cst))
+        {
+          {
+          std::lock_guard<std::mutex> lock{m_mutex};
+          }
+        m_wakeup.notify_one();
+        }
+      }
+
+    private:
+      std::mutex m_mutex{};
+      std::condition_variable m_wakeup{};
+      std::atomic<bool> m_parked{};
+    };
+
+  /**
+   * @brief A wait strategy that spins for a short time before polling the condition at a fixed interval
+   *
+   * Waiting consumers poll the condition #kSpinCount times, before they sleep for #interval between further
+   * polls. Notifying is free, so this strategy suits consumers for which a wake-up latency of up to #interval
+   * is acceptable, while the notifying thread must never enter the kernel.
+   *
+   * @since 1.1.0
+   */
+  struct poll_wait
+    {
+    /**
+     * @brief The number of times the condition is polled before the waiting thread starts to sleep
+     */
+    static std::size_t constexpr kSpinCount = 4096;
+
+    /**
+     * @brief The time the waiting thread sleeps between two polls
+     */
+    static std::chrono::microseconds interval()
+      {
+      return std::chrono::microseconds{500};
+      }
+
+    template<typename Predicate>
+    void wait(Predicate ready)
+      {
+      for(std::size_t spin = 0; spin < kSpinCount; ++spin)
+        {
+        if(ready())
+          {
+          return;
+          }
+        internal::cpu_relax();
+        }
+
+      while(!ready())
+        {
+        std::this_thread::sleep_for(interval());
+        }
+      }
+
+    void notify()
+      {
+
+      }
+    };
+
+#if defined(__linux__)
+  /**
+   * @brief A wait strategy that spins for a short time before sleeping on a futex
+   *
+   * This strategy behaves like dab::spin_then_park_wait, but parks the waiting thread directly on a Linux
+   * futex. Neither side ever acquires a mutex, and waking the consumer costs a single system call. This
+   * strategy is only available on Linux.
+   *
+   * @since 1.1.0
+   */
+  struct futex_wait
+    {
+    /**
+     * @brief The number of times the condition is polled before the waiting thread goes to sleep
+     */
+    static std::size_t constexpr kSpinCount = 4096;
+
+    template<typename Predicate>
+    void wait(Predicate ready)
+      {
+      for(std::size_t spin = 0; spin < kSpinCount; ++spin)
+        {
+        if(ready())
+          {
+          return;
+          }
+        internal::cpu_relax();
+        }
+
+      while(true)
+        {
+        auto const epoch = m_epoch.load(std::memory_order_seq_cst);
+        m_sleeping.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(ready())
+          {
+          m_sleeping.store(false, std::memory_order_relaxed);
+          return;
+          }
+
+        syscall(SYS_futex, futex(), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+        m_sleeping.store(false, std::memory_order_relaxed);
+        }
+      }
+
+    void notify()
+      {
+      m_epoch.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(m_sleeping.load(std::memory_order_seq_cst))
+        {
+        syscall(SYS_futex, futex(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+        }
+      }
+
+    private:
+      static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "The futex word must be 32 bits wide");
+
+      std::uint32_t * futex()
+        {
+        return reinterpret_cast<std::uint32_t *>(&m_epoch);
+        }
+
+      std::atomic<std::uint32_t> m_epoch{};
+      std::atomic<bool> m_sleeping{};
+    };
+#endif
+
+  }
+
+#endif
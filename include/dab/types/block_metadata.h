@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TYPES_BLOCK_METADATA
+#define DABDEVICE_TYPES_BLOCK_METADATA
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+namespace dab
+  {
+
+  /**
+   * @brief The circumstances under which a block of samples was acquired
+   *
+   * Devices describe every block of raw samples to their sink right before delivering it. Transports that keep
+   * their samples in blocks, like dab::basic_block_pool, attach the description to every block they hand out.
+   * The metadata is a fixed-size POD, so that attaching it neither allocates nor costs more than a copy.
+   *
+   * @since 1.1.0
+   */
+  struct block_metadata
+    {
+    /**
+     * @brief Samples were lost between the previous block and this one
+     */
+    static std::uint32_t constexpr kDiscontinuity = 1u << 0;
+
+    /**
+     * @brief This block is the first one acquired at its center frequency and gain
+     */
+    static std::uint32_t constexpr kRetuned = 1u << 1;
+
+    /**
+     * @brief The number of blocks committed to the transport before this one
+     *
+     * Blocks that were discarded by the transport to make room for newer ones leave a gap in the sequence.
+     */
+    std::uint64_t sequence;
+
+    /**
+     * @brief The index of the first sample of this block in the stream of samples acquired by the device
+     *
+     * Samples that were dropped because the transport was full still count, so the difference to the index
+     * expected from the previous block is the number of lost samples.
+     */
+    std::uint64_t sampleIndex;
+
+    /**
+     * @brief The time the block was acquired, in nanoseconds since the epoch of std::chrono::steady_clock
+     *
+     * On Linux, this is the time of CLOCK_MONOTONIC.
+     */
+    std::int64_t timestamp;
+
+    /**
+     * @brief The center frequency the block was acquired at in Hz
+     */
+    std::uint32_t centerFrequency;
+
+    /**
+     * @brief The gain the block was acquired with in dB
+     */
+    float gain;
+
+    /**
+     * @brief A combination of #kDiscontinuity and #kRetuned
+     */
+    std::uint32_t flags;
+
+    /**
+     * @brief Check whether @p flag is set
+     */
+    bool has(std::uint32_t const flag) const
+      {
+      return (flags & flag) == flag;
+      }
+
+    /**
+     * @brief Get the time the block was acquired
+     */
+    std::chrono::steady_clock::time_point captured() const
+      {
+      using std::chrono::steady_clock;
+      return steady_clock::time_point{std::chrono::duration_cast<steady_clock::duration>(std::chrono::nanoseconds{timestamp})};
+      }
+    };
+
+  static_assert(std::is_pod<block_metadata>::value, "dab::block_metadata must be a POD");
+
+  }
+
+#endif
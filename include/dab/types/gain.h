@@ -32,9 +32,11 @@
 #ifndef DABDEVICE_TYPES_GAIN
 #define DABDEVICE_TYPES_GAIN
 
+#include <cmath>
 #include <cstdint>
 
 #include <ostream>
+#include <vector>
 
 namespace dab
   {
@@ -98,6 +100,35 @@ namespace dab
     return out << gain.value() << " dB";
     }
 
+  /**
+   * @brief Find the gain in @p gains that is closest to @p target
+   *
+   * Devices usually only support a discrete set of gains. This function selects the supported gain that
+   * best approximates a requested one. If several gains are equally close, the first one is chosen.
+   *
+   * @return The closest gain, or @p target if @p gains is empty
+   *
+   * @since 1.1.0
+   */
+  inline gain closest_gain(std::vector<gain> const & gains, gain const target)
+    {
+    if(gains.empty())
+      {
+      return target;
+      }
+
+    auto closest = gains.front();
+    for(auto const & current : gains)
+      {
+      if(std::abs(target.value() - current.value()) < std::abs(target.value() - closest.value()))
+        {
+        closest = current;
+        }
+      }
+
+    return closest;
+    }
+
   /**
    * @namespace literals
    *
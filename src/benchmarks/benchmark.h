@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_BENCHMARKS_BENCHMARK
+#define DABDEVICE_BENCHMARKS_BENCHMARK
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace benchmark
+    {
+
+    /**
+     * @brief The body of a benchmark
+     *
+     * The body performs the measured operation @p iterations times and returns the number of items (samples,
+     * calls, ...) it processed in total.
+     */
+    using body = std::function<std::uint64_t(std::uint64_t iterations)>;
+
+    /**
+     * @brief Additional named values reported alongside the measurements of a benchmark
+     */
+    using counters = std::vector<std::pair<std::string, double>>;
+
+    /**
+     * @brief A function reporting counters that are only known once a benchmark has run
+     *
+     * The function is called after the final run of the benchmark, so the body can store what it observed,
+     * like a latency distribution, and the report presents the observations of the measured run.
+     */
+    using report = std::function<counters()>;
+
+    /**
+     * @brief Prevent the compiler from discarding the computation of @p value
+     */
+    template<typename ValueType>
+    void keep(ValueType const & value)
+      {
+      asm volatile("" : : "g"(&value) : "memory");
+      }
+
+    /**
+     * @brief The measurements of a single benchmark
+     */
+    struct result
+      {
+      std::string name;
+      std::uint64_t iterations;
+      double seconds;
+      double cpuSeconds;
+      std::uint64_t items;
+      counters extra;
+      };
+
+    /**
+     * @brief A minimal benchmark runner
+     *
+     * Every benchmark is run with an increasing number of iterations, until a single run takes at least the
+     * minimum time. The results of the final run, including the share of CPU time the process spent during it
+     * and any extra counters, are reported either as a human readable table, or as JSON in the format used by
+     * Google Benchmark, so that existing tooling can be used to compare runs.
+     *
+     * The runner understands the following command line arguments:
+     *   --json            Report the results as JSON
+     *   --filter=<text>   Only run benchmarks whose name contains <text>
+     *   --min-time=<s>    The minimum duration of a measured run in seconds (default: 0.5)
+     */
+    struct runner
+      {
+      /**
+       * @brief Register the benchmark @p name, reporting the @p extra counters with its results
+       */
+      void add(std::string name, body benchmark, counters extra = {})
+        {
+        m_benchmarks.push_back({std::move(name), std::move(benchmark), [extra]{ return extra; }});
+        }
+
+      /**
+       * @brief Register the benchmark @p name, reporting the counters returned by @p extra after its final run
+       */
+      void add(std::string name, body benchmark, report extra)
+        {
+        m_benchmarks.push_back({std::move(name), std::move(benchmark), std::move(extra)});
+        }
+
+      /**
+       * @brief Run all registered benchmarks matching the command line filter
+       */
+      int run(int argc, char * * argv)
+        {
+        auto json = false;
+        auto filter = std::string{};
+        auto minTime = 0.5;
+
+        for(auto argument = 1; argument < argc; ++argument)
+          {
+          auto const current = std::string{argv[argument]};
+          if(current == "--json")
+            {
+            json = true;
+            }
+          else if(!current.compare(0, 9, "--filter="))
+            {
+            filter = current.substr(9);
+            }
+          else if(!current.compare(0, 11, "--min-time="))
+            {
+            minTime = std::atof(current.c_str() + 11);
+            }
+          else
+            {
+            std::cerr << "usage: " << argv[0] << " [--json] [--filter=<text>] [--min-time=<seconds>]\n";
+            return EXIT_FAILURE;
+            }
+          }
+
+        auto results = std::vector<result>{};
+        for(auto & benchmark : m_benchmarks)
+          {
+          if(benchmark.name.find(filter) == std::string::npos)
+            {
+            continue;
+            }
+
+          results.push_back(measure(benchmark, minTime));
+          if(!json)
+            {
+            print(results.back());
+            }
+          }
+
+        if(json)
+          {
+          report(results);
+          }
+
+        return EXIT_SUCCESS;
+        }
+
+      private:
+        struct entry
+          {
+          std::string name;
+          body benchmark;
+          report extra;
+          };
+
+        static result measure(entry const & benchmark, double minTime)
+          {
+          auto iterations = std::uint64_t{1};
+          while(true)
+            {
+            auto const cpuStart = std::clock();
+            auto const start = std::chrono::steady_clock::now();
+            auto const items = benchmark.benchmark(iterations);
+            auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            auto const cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+            if(seconds >= minTime || iterations >= (std::uint64_t{1} << 40))
+              {
+              return {benchmark.name, iterations, seconds, cpuSeconds, items, benchmark.extra()};
+              }
+
+            auto const factor = seconds > 0 ? minTime / seconds * 1.2 : 10.0;
+            iterations = static_cast<std::uint64_t>(iterations * std::min(std::max(factor, 2.0), 10.0));
+            }
+          }
+
+        static void print(result const & measured)
+          {
+          std::cout << std::left << std::setw(48) << measured.name << std::right << std::fixed
+                    << std::setw(14) << std::setprecision(1) << measured.seconds * 1e9 / measured.iterations << " ns"
+                    << std::setw(14) << std::setprecision(2) << measured.items / measured.seconds / 1e6 << " M/s"
+                    << std::setw(14) << measured.iterations << " iterations"
+                    << std::setw(8) << std::setprecision(0) << measured.cpuSeconds / measured.seconds * 100 << " % CPU";
+
+          for(auto const & counter : measured.extra)
+            {
+            std::cout << "  " << counter.first << '=' << std::setprecision(2) << counter.second;
+            }
+          std::cout << '\n';
+          }
+
+        static std::string escape(std::string const & text)
+          {
+          auto escaped = std::string{};
+          for(auto const character : text)
+            {
+            if(character == '"' || character == '\\')
+              {
+              escaped += '\\';
+              }
+            escaped += character;
+            }
+          return escaped;
+          }
+
+        static void report(std::vector<result> const & results)
+          {
+          std::ostringstream out{};
+          out << std::setprecision(10);
+          out << "{\n"
+              << "  \"context\": {\n"
+              << "    \"library\": \"libdabdevice\""
+#if defined(__VERSION__)
+              << ",\n    \"compiler\": \"" << escape(__VERSION__) << "\""
+#endif
+              << "\n  },\n"
+              << "  \"benchmarks\": [";
+
+          auto first = true;
+          for(auto const & measured : results)
+            {
+            out << (first ? "\n" : ",\n")
+                << "    {\n"
+                << "      \"name\": \"" << escape(measured.name) << "\",\n"
+                << "      \"run_type\": \"iteration\",\n"
+                << "      \"iterations\": " << measured.iterations << ",\n"
+                << "      \"real_time\": " << measured.seconds * 1e9 / measured.iterations << ",\n"
+                << "      \"cpu_time\": " << measured.cpuSeconds * 1e9 / measured.iterations << ",\n"
+                << "      \"time_unit\": \"ns\",\n"
+                << "      \"items_per_second\": " << measured.items / measured.seconds;
+
+            for(auto const & counter : measured.extra)
+              {
+              out << ",\n      \"" << escape(counter.first) << "\": " << counter.second;
+              }
+
+            out << "\n    }";
+            first = false;
+            }
+
+          out << "\n  ]\n}\n";
+          std::cout << out.str();
+          }
+
+        std::vector<entry> m_benchmarks{};
+      };
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.h"
+
+#include <dab/conversion/converter.h>
+#include <dab/conversion/kernels.h>
+#include <dab/conversion/lookup_table.h>
+#include <dab/device/rtl_file.h>
+#include <dab/device/rtl_mmap_file.h>
+#include <dab/transport/sink.h>
+#include <dab/types/gain.h>
+
+#include <dab/types/common_types.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  using sample_t = dab::internal::sample_t;
+
+  auto constexpr kBlockSize = std::size_t{128 * 1024};
+
+  // A sink that accepts every sample, so that only the device side is measured
+  template<typename SampleType>
+  struct discarding_sink : dab::basic_sink<SampleType>
+    {
+    SampleType * reserve(std::size_t & count) override
+      {
+      if(m_storage.size() < count)
+        {
+        m_storage.resize(count);
+        }
+      return m_storage.data();
+      }
+
+    void commit(std::size_t count) override
+      {
+      m_samples += count;
+      }
+
+    std::uint64_t samples() const
+      {
+      return m_samples;
+      }
+
+    private:
+      std::vector<SampleType> m_storage{};
+      std::uint64_t m_samples{};
+    };
+
+  std::vector<std::uint8_t> raw_block(std::size_t nofSamples)
+    {
+    auto raw = std::vector<std::uint8_t>(2 * nofSamples);
+    for(std::size_t index = 0; index < raw.size(); ++index)
+      {
+      raw[index] = static_cast<std::uint8_t>(index * 7 + index / 256);
+      }
+    return raw;
+    }
+
+  std::string make_recording(std::size_t size)
+    {
+    auto const name = "device_benchmark_" + std::to_string(size) + ".raw";
+    auto const raw = raw_block(size / 2);
+    std::ofstream file{name, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<char const *>(raw.data()), raw.size());
+    return name;
+    }
+
+  void add_conversion_benchmarks(dab::benchmark::runner & runner)
+    {
+    struct kernel_info
+      {
+      char const * name;
+      dab::conversion::isa target;
+      };
+
+    kernel_info const kernels[] = {
+      {"scalar", dab::conversion::isa::scalar},
+      {"sse2", dab::conversion::isa::sse2},
+      {"avx2", dab::conversion::isa::avx2},
+      {"avx512", dab::conversion::isa::avx512},
+    };
+
+    for(auto const & kernel : kernels)
+      {
+      if(!dab::conversion::supported(kernel.target))
+        {
+        continue;
+        }
+
+      auto const convert = dab::conversion::kernel_for(kernel.target);
+      runner.add(std::string{"conversion/float/"} + kernel.name, [convert](std::uint64_t iterations){
+        auto const raw = raw_block(kBlockSize);
+        auto samples = std::vector<sample_t>(kBlockSize);
+        for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+          {
+          convert(raw.data(), kBlockSize, samples.data());
+          dab::benchmark::keep(samples.back());
+          }
+        return iterations * kBlockSize;
+      });
+
+      auto const convertFixed = dab::conversion::fixed_kernel_for(kernel.target);
+      runner.add(std::string{"conversion/fixed/"} + kernel.name, [convertFixed](std::uint64_t iterations){
+        auto const raw = raw_block(kBlockSize);
+        auto samples = std::vector<dab::fixed_sample>(kBlockSize);
+        for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+          {
+          convertFixed(raw.data(), kBlockSize, samples.data());
+          dab::benchmark::keep(samples.back());
+          }
+        return iterations * kBlockSize;
+      });
+      }
+
+    runner.add("conversion/float/lookup_table", [](std::uint64_t iterations){
+      auto const raw = raw_block(kBlockSize);
+      auto samples = std::vector<sample_t>(kBlockSize);
+      auto const table = dab::conversion::lookup_table{dab::conversion::calibration{0.01f, -0.01f, 1.02f}};
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        table.convert(raw.data(), kBlockSize, samples.data());
+        dab::benchmark::keep(samples.back());
+        }
+      return iterations * kBlockSize;
+    });
+    }
+
+  void add_queue_benchmarks(dab::benchmark::runner & runner)
+    {
+    runner.add("queue/enqueue_per_sample", [](std::uint64_t iterations){
+      dab::sample_queue_t queue{};
+      auto samples = std::vector<sample_t>(kBlockSize);
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        for(auto const & sample : samples)
+          {
+          queue.enqueue(sample);
+          }
+        queue.dequeue(samples);
+        }
+      return iterations * kBlockSize;
+    });
+
+    runner.add("queue/enqueue_bulk", [](std::uint64_t iterations){
+      dab::sample_queue_t queue{};
+      auto samples = std::vector<sample_t>(kBlockSize);
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        queue.enqueue(samples);
+        queue.dequeue(samples);
+        }
+      return iterations * kBlockSize;
+    });
+    }
+
+  template<typename Device>
+  void add_replay_benchmark(dab::benchmark::runner & runner, std::string const & kind, std::string const & recording, std::size_t size)
+    {
+    runner.add("replay/" + kind + "/" + std::to_string(size / 1024) + "KiB", [recording](std::uint64_t iterations){
+      discarding_sink<sample_t> sink{};
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        Device device{sink, recording};
+        device.run();
+        }
+      return sink.samples();
+    });
+    }
+
+  void add_control_benchmarks(dab::benchmark::runner & runner, std::string const & recording)
+    {
+    runner.add("control/closest_gain", [](std::uint64_t iterations){
+      // The gain table of the R820T tuner found in most RTLSDR sticks
+      auto const gains = std::vector<dab::gain>{
+        dab::gain{0.0f}, dab::gain{0.9f}, dab::gain{1.4f}, dab::gain{2.7f}, dab::gain{3.7f}, dab::gain{7.7f},
+        dab::gain{8.7f}, dab::gain{12.5f}, dab::gain{14.4f}, dab::gain{15.7f}, dab::gain{16.6f}, dab::gain{19.7f},
+        dab::gain{20.7f}, dab::gain{22.9f}, dab::gain{25.4f}, dab::gain{28.0f}, dab::gain{29.7f}, dab::gain{32.8f},
+        dab::gain{33.8f}, dab::gain{36.4f}, dab::gain{37.2f}, dab::gain{38.6f}, dab::gain{40.2f}, dab::gain{42.1f},
+        dab::gain{43.4f}, dab::gain{43.9f}, dab::gain{44.5f}, dab::gain{48.0f}, dab::gain{49.6f},
+      };
+
+      auto checksum = 0.0f;
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        checksum += dab::closest_gain(gains, dab::gain{float(iteration % 50)}).value();
+        }
+      dab::benchmark::keep(checksum);
+      return iterations;
+    });
+
+    runner.add("control/tune/uncalibrated", [recording](std::uint64_t iterations){
+      discarding_sink<sample_t> sink{};
+      dab::rtl_file device{sink, recording};
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        device.tune(dab::frequency{std::uint32_t(174928000 + iteration % 2 * 1712000)});
+        }
+      return iterations;
+    });
+
+    runner.add("control/tune/calibrated", [recording](std::uint64_t iterations){
+      discarding_sink<sample_t> sink{};
+      dab::rtl_file device{sink, recording};
+      device.calibrate([](dab::frequency frequency, dab::gain){
+        return dab::conversion::calibration{std::uint32_t(frequency) / 1e12f};
+      });
+      for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+        {
+        device.tune(dab::frequency{std::uint32_t(174928000 + iteration % 2 * 1712000)});
+        }
+      return iterations;
+    });
+    }
+
+  }
+
+int main(int argc, char * * argv)
+  {
+  auto runner = dab::benchmark::runner{};
+  auto recordings = std::vector<std::string>{};
+
+  add_conversion_benchmarks(runner);
+  add_queue_benchmarks(runner);
+
+  for(auto const size : {std::size_t{64 * 1024}, std::size_t{1024 * 1024}, std::size_t{16 * 1024 * 1024}})
+    {
+    recordings.push_back(make_recording(size));
+    add_replay_benchmark<dab::rtl_file>(runner, "rtl_file", recordings.back(), size);
+    add_replay_benchmark<dab::rtl_mmap_file>(runner, "rtl_mmap_file", recordings.back(), size);
+    }
+
+  add_control_benchmarks(runner, recordings.front());
+
+  auto const result = runner.run(argc, argv);
+
+  for(auto const & recording : recordings)
+    {
+    std::remove(recording.c_str());
+    }
+
+  return result;
+  }
@@ -0,0 +1,427 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.h"
+
+#include <dab/device/rtl_device.h>
+#include <dab/device/rtl_file.h>
+#include <dab/transport/block_pool.h>
+#include <dab/transport/sink.h>
+#include <dab/transport/spsc_ring.h>
+#include <dab/types/block_metadata.h>
+
+#include <dab/types/common_types.h>
+
+#include <fake_rtlsdr.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+
+  using sample_t = dab::internal::sample_t;
+  using clock = std::chrono::steady_clock;
+
+  // The number of blocks every transport can hold before the device has to drop samples
+  auto constexpr kBufferedBlocks = std::size_t{8};
+
+  // The rate at which the devices release samples, relative to a real receiver
+  auto constexpr kSpeed = 1.0;
+
+  // Remembers when the samples committed to a sink were acquired, until the consumer has taken them
+  struct stamp_log
+    {
+    void produced(std::uint64_t const end, clock::time_point const captured)
+      {
+      std::lock_guard<std::mutex> lock{m_lock};
+      m_stamps.emplace_back(end, captured);
+      }
+
+    void consumed(std::uint64_t const count, std::vector<double> & latencies)
+      {
+      auto const now = clock::now();
+      m_consumed += count;
+
+      std::lock_guard<std::mutex> lock{m_lock};
+      while(!m_stamps.empty() && m_stamps.front().first <= m_consumed)
+        {
+        latencies.push_back(std::chrono::duration<double, std::micro>(now - m_stamps.front().second).count());
+        m_stamps.pop_front();
+        }
+      }
+
+    private:
+      std::mutex m_lock{};
+      std::deque<std::pair<std::uint64_t, clock::time_point>> m_stamps{};
+      std::uint64_t m_consumed{};
+    };
+
+  // A sink that passes everything on to another sink, logging the acquisition time of every commit
+  template<typename SampleType>
+  struct timed_sink : dab::basic_sink<SampleType>
+    {
+    timed_sink(dab::basic_sink<SampleType> & target, stamp_log & log) :
+      m_target{target},
+      m_log{log}
+      {
+
+      }
+
+    SampleType * reserve(std::size_t & count) override
+      {
+      return m_target.reserve(count);
+      }
+
+    void commit(std::size_t count) override
+      {
+      m_committed += count;
+      m_log.produced(m_committed, m_captured);
+      m_target.commit(count);
+      }
+
+    std::size_t buffered() const override
+      {
+      return m_target.buffered();
+      }
+
+    bool observes_consumer() const override
+      {
+      return m_target.observes_consumer();
+      }
+
+    bool wait_for_room(std::chrono::milliseconds const timeout) override
+      {
+      return m_target.wait_for_room(timeout);
+      }
+
+    std::size_t discard_oldest() override
+      {
+      return m_target.discard_oldest();
+      }
+
+    void discontinuity(std::size_t const count) override
+      {
+      m_target.discontinuity(count);
+      }
+
+    void retuned(dab::frequency const centerFrequency) override
+      {
+      m_target.retuned(centerFrequency);
+      }
+
+    void acquired(dab::block_metadata const & metadata) override
+      {
+      m_captured = metadata.captured();
+      m_target.acquired(metadata);
+      }
+
+    private:
+      dab::basic_sink<SampleType> & m_target;
+      stamp_log & m_log;
+      std::uint64_t m_committed{};
+      clock::time_point m_captured{};
+    };
+
+  // Keeps the given number of threads spinning, competing with the device and the consumer for the CPU
+  struct contention
+    {
+    explicit contention(unsigned const nofThreads)
+      {
+      for(auto thread = 0u; thread < nofThreads; ++thread)
+        {
+        m_threads.emplace_back([this]{
+          auto spins = std::uint64_t{};
+          while(m_running.load(std::memory_order_relaxed))
+            {
+            dab::benchmark::keep(++spins);
+            }
+        });
+        }
+      }
+
+    ~contention()
+      {
+      m_running.store(false, std::memory_order_relaxed);
+      for(auto & thread : m_threads)
+        {
+        thread.join();
+        }
+      }
+
+    private:
+      std::atomic<bool> m_running{true};
+      std::vector<std::thread> m_threads{};
+    };
+
+  struct pool_transport
+    {
+    static char const * name()
+      {
+      return "block_pool";
+      }
+
+    explicit pool_transport(std::size_t const blockSize) :
+      m_pool{kBufferedBlocks, blockSize}
+      {
+
+      }
+
+    dab::sample_sink & sink()
+      {
+      return m_pool;
+      }
+
+    std::size_t take()
+      {
+      auto block = m_pool.receive();
+      dab::benchmark::keep(block[block.size() - 1]);
+      return block.size();
+      }
+
+    private:
+      dab::sample_block_pool m_pool;
+    };
+
+  struct ring_transport
+    {
+    static char const * name()
+      {
+      return "spsc_ring";
+      }
+
+    explicit ring_transport(std::size_t const blockSize) :
+      m_ring{kBufferedBlocks * blockSize},
+      m_buffer(blockSize)
+      {
+
+      }
+
+    dab::sample_sink & sink()
+      {
+      return m_ring;
+      }
+
+    std::size_t take()
+      {
+      auto const count = m_ring.read(m_buffer.data(), m_buffer.size());
+      dab::benchmark::keep(m_buffer[count - 1]);
+      return count;
+      }
+
+    private:
+      dab::sample_ring m_ring;
+      std::vector<sample_t> m_buffer;
+    };
+
+  struct queue_transport
+    {
+    static char const * name()
+      {
+      return "queue";
+      }
+
+    explicit queue_transport(std::size_t const blockSize) :
+      m_buffer(blockSize)
+      {
+
+      }
+
+    dab::sample_sink & sink()
+      {
+      return m_sink;
+      }
+
+    std::size_t take()
+      {
+      m_queue.dequeue(m_buffer);
+      dab::benchmark::keep(m_buffer.back());
+      return m_buffer.size();
+      }
+
+    private:
+      dab::sample_queue_t m_queue{};
+      dab::queue_sink m_sink{m_queue};
+      std::vector<sample_t> m_buffer;
+    };
+
+  // Run the device on its own thread until the consumer has taken the given number of samples
+  template<typename Transport>
+  std::uint64_t consume(dab::device & device, Transport & transport, stamp_log & log, std::uint64_t const nofSamples,
+                        std::vector<double> & latencies)
+    {
+    auto producer = std::thread{[&]{ device.run(); }};
+
+    auto consumed = std::uint64_t{};
+    while(consumed < nofSamples)
+      {
+      auto const count = transport.take();
+      log.consumed(count, latencies);
+      consumed += count;
+      }
+
+    device.stop();
+    producer.join();
+    return consumed;
+    }
+
+  // Summarize the latency distribution of the final run of a benchmark
+  dab::benchmark::counters distribution(std::vector<double> latencies)
+    {
+    if(latencies.empty())
+      {
+      return {};
+      }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto const percentile = [&](double fraction){
+      return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(fraction * latencies.size()))];
+    };
+
+    return {
+      {"p50_us", percentile(0.5)},
+      {"p99_us", percentile(0.99)},
+      {"p999_us", percentile(0.999)},
+      {"max_us", latencies.back()},
+      {"blocks", double(latencies.size())},
+    };
+    }
+
+  // Register the latency benchmark of the device created by @p start with every contention scenario
+  template<typename Transport, typename Factory>
+  void add_scenarios(dab::benchmark::runner & runner, std::string const & name, std::size_t const blockSize,
+                     Factory start)
+    {
+    struct scenario
+      {
+      char const * name;
+      unsigned nofThreads;
+      };
+
+    scenario const scenarios[] = {
+      {"idle", 0},
+      {"contended", std::max(std::thread::hardware_concurrency(), 1u)},
+    };
+
+    for(auto const & current : scenarios)
+      {
+      auto const latencies = std::make_shared<std::vector<double>>();
+      auto const nofThreads = current.nofThreads;
+
+      runner.add("latency/" + name + "/" + Transport::name() + "/" + current.name, [=](std::uint64_t iterations){
+        latencies->clear();
+        contention const competitors{nofThreads};
+
+        Transport transport{blockSize};
+        stamp_log log{};
+        timed_sink<sample_t> sink{transport.sink(), log};
+        auto const device = start(sink);
+        return consume(*device, transport, log, iterations * blockSize, *latencies);
+      }, [latencies]{ return distribution(*latencies); });
+      }
+    }
+
+  template<typename Transport>
+  void add_device_benchmarks(dab::benchmark::runner & runner, std::string const & name,
+                             dab::rtl_transfers const transfers)
+    {
+    add_scenarios<Transport>(runner, "rtl_device/" + name, transfers.samples(), [transfers](dab::sink & sink){
+      auto configuration = fake_rtlsdr::configuration{};
+      configuration.speed = kSpeed;
+      fake_rtlsdr::configure(configuration);
+
+      auto device = std::unique_ptr<dab::rtl_device>{new dab::rtl_device{sink}};
+      device->transfers(transfers);
+      return device;
+    });
+    }
+
+  template<typename Transport>
+  void add_file_benchmarks(dab::benchmark::runner & runner, std::string const & recording, std::size_t const blockSize)
+    {
+    auto const name = "rtl_file/" + std::to_string(blockSize * 2 / 1024) + "KiB";
+    add_scenarios<Transport>(runner, name, blockSize, [recording, blockSize](dab::sink & sink){
+      auto device = std::unique_ptr<dab::rtl_file>{new dab::rtl_file{sink, recording, blockSize * 2}};
+      device->enable(dab::device::option::loop);
+      device->pace(kSpeed);
+      return device;
+    });
+    }
+
+  template<typename Transport>
+  void add_transport_benchmarks(dab::benchmark::runner & runner, std::string const & recording)
+    {
+    add_device_benchmarks<Transport>(runner, "low_latency", dab::rtl_transfers::low_latency());
+    add_device_benchmarks<Transport>(runner, "balanced", dab::rtl_transfers::balanced());
+    add_file_benchmarks<Transport>(runner, recording, dab::rtl_transfers::low_latency().samples());
+    add_file_benchmarks<Transport>(runner, recording, dab::rtl_transfers::balanced().samples());
+    }
+
+  std::string make_recording(std::size_t const size)
+    {
+    auto const name = std::string{"latency_benchmark.raw"};
+    auto raw = std::vector<std::uint8_t>(size);
+    for(std::size_t index = 0; index < raw.size(); ++index)
+      {
+      raw[index] = static_cast<std::uint8_t>(index);
+      }
+
+    std::ofstream file{name, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<char const *>(raw.data()), raw.size());
+    return name;
+    }
+
+  }
+
+int main(int argc, char * * argv)
+  {
+  auto runner = dab::benchmark::runner{};
+  auto const recording = make_recording(4 * 1024 * 1024);
+
+  add_transport_benchmarks<pool_transport>(runner, recording);
+  add_transport_benchmarks<ring_transport>(runner, recording);
+  add_transport_benchmarks<queue_transport>(runner, recording);
+
+  auto const result = runner.run(argc, argv);
+  std::remove(recording.c_str());
+  return result;
+  }
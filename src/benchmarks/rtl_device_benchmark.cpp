@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.h"
+
+#include <dab/device/pacer.h>
+#include <dab/device/rtl_device.h>
+#include <dab/transport/sink.h>
+#include <dab/types/fixed_sample.h>
+#include <dab/types/raw_sample.h>
+
+#include <dab/types/common_types.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  // The number of samples librtlsdr delivers per callback with the default buffer size
+  auto const kBufferSamples = std::uint64_t{fake_rtlsdr::configuration{}.bufferLength / 2};
+
+  // A sink that stops the device once it has been offered a given number of samples
+  template<typename SampleType>
+  struct stopping_sink : dab::basic_sink<SampleType>
+    {
+    stopping_sink(std::uint64_t const limit, bool const accept) :
+      m_limit{limit},
+      m_accept{accept}
+      {
+
+      }
+
+    SampleType * reserve(std::size_t & count) override
+      {
+      if(!m_accept)
+        {
+        offer(count);
+        return nullptr;
+        }
+
+      if(m_storage.size() < count)
+        {
+        m_storage.resize(count);
+        }
+      return m_storage.data();
+      }
+
+    void commit(std::size_t count) override
+      {
+      dab::benchmark::keep(m_storage[count - 1]);
+      offer(count);
+      }
+
+    void stop(dab::device & device)
+      {
+      m_device = &device;
+      }
+
+    private:
+      void offer(std::size_t count)
+        {
+        m_offered += count;
+        if(m_offered >= m_limit && m_device)
+          {
+          m_device->stop();
+          m_device = nullptr;
+          }
+        }
+
+      std::uint64_t const m_limit;
+      bool const m_accept;
+      std::uint64_t m_offered{};
+      std::vector<SampleType> m_storage{};
+      dab::device * m_device{};
+    };
+
+  // Acquire the given number of buffers, measuring the cost of the callback and the conversion
+  template<typename SampleType>
+  dab::benchmark::body acquire(bool const accept)
+    {
+    return [accept](std::uint64_t iterations){
+      fake_rtlsdr::configure(fake_rtlsdr::configuration{});
+
+      stopping_sink<SampleType> sink{iterations * kBufferSamples, accept};
+      dab::rtl_device device{sink};
+      sink.stop(device);
+      device.run();
+
+      return fake_rtlsdr::stats().bytes / 2;
+    };
+    }
+
+  // Acquire the given number of transfers at the given speed, measuring the CPU time the transfers cost
+  dab::benchmark::body acquire_with(dab::rtl_transfers const transfers, double const speed)
+    {
+    return [transfers, speed](std::uint64_t iterations){
+      auto configuration = fake_rtlsdr::configuration{};
+      configuration.speed = speed;
+      fake_rtlsdr::configure(configuration);
+
+      stopping_sink<dab::internal::sample_t> sink{iterations * transfers.samples(), true};
+      dab::rtl_device device{sink};
+      device.transfers(transfers);
+      sink.stop(device);
+      device.run();
+
+      return fake_rtlsdr::stats().bytes / 2;
+    };
+    }
+
+  // Register the unthrottled and the real-time acquisition with the given transfers
+  void add_transfers(dab::benchmark::runner & runner, std::string const & name, dab::rtl_transfers const transfers)
+    {
+    auto const latency = dab::benchmark::counters{
+      {"period_ms", transfers.period().count() / 1000.0},
+      {"capacity_ms", transfers.capacity().count() / 1000.0},
+    };
+
+    runner.add("rtl_device/transfers/" + name, acquire_with(transfers, dab::pacer::kUnthrottled), latency);
+    runner.add("rtl_device/transfers/" + name + "/real_time", acquire_with(transfers, 1.0), latency);
+    }
+
+  // Start the acquisition and stop it as soon as the first buffer arrived
+  std::uint64_t start_stop(std::uint64_t iterations)
+    {
+    fake_rtlsdr::configure(fake_rtlsdr::configuration{});
+
+    stopping_sink<dab::raw_sample> sink{1, true};
+    dab::rtl_device device{sink};
+    for(std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+      {
+      sink.stop(device);
+      device.run();
+      }
+
+    return iterations;
+    }
+
+  }
+
+int main(int argc, char * * argv)
+  {
+  auto runner = dab::benchmark::runner{};
+
+  runner.add("rtl_device/callback/float", acquire<dab::internal::sample_t>(true));
+  runner.add("rtl_device/callback/fixed", acquire<dab::fixed_sample>(true));
+  runner.add("rtl_device/callback/raw", acquire<dab::raw_sample>(true));
+  runner.add("rtl_device/callback/dropped", acquire<dab::raw_sample>(false));
+  runner.add("rtl_device/start_stop", start_stop);
+
+  add_transfers(runner, "low_latency", dab::rtl_transfers::low_latency());
+  add_transfers(runner, "balanced", dab::rtl_transfers::balanced());
+  add_transfers(runner, "high_throughput", dab::rtl_transfers::high_throughput());
+
+  return runner.run(argc, argv);
+  }
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.h"
+
+#include <dab/conversion/converter.h>
+#include <dab/transport/block_pool.h>
+#include <dab/transport/sink.h>
+#include <dab/transport/spsc_ring.h>
+#include <dab/transport/wait_strategy.h>
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+  {
+
+  using sample_t = dab::internal::sample_t;
+
+  // The number of samples librtlsdr delivers per callback with the default buffer size
+  auto constexpr kBlockSize = std::size_t{128 * 1024};
+
+  // The producer converts the same block of raw samples over and over again, just like a device would
+  std::vector<std::uint8_t> make_raw_block(std::size_t blockSize)
+    {
+    auto raw = std::vector<std::uint8_t>(blockSize * 2);
+    for(std::size_t index = 0; index < raw.size(); ++index)
+      {
+      raw[index] = static_cast<std::uint8_t>(index * 7);
+      }
+    return raw;
+    }
+
+  // Publish all samples into the sink, retrying while the sink is full so that no samples are lost
+  void produce(dab::sample_sink & sink, std::size_t nofSamples, std::size_t blockSize)
+    {
+    dab::conversion::converter const converter{};
+    auto const raw = make_raw_block(blockSize);
+
+    for(std::size_t produced = 0; produced < nofSamples;)
+      {
+      auto count = std::min(blockSize, nofSamples - produced);
+      auto const target = sink.reserve(count);
+      if(!target)
+        {
+        std::this_thread::yield();
+        continue;
+        }
+
+      converter.convert(raw.data(), count, target);
+      sink.commit(count);
+      produced += count;
+      }
+    }
+
+  std::uint64_t run_queue(std::uint64_t iterations)
+    {
+    auto const nofSamples = iterations * kBlockSize;
+    dab::sample_queue_t queue{};
+    dab::queue_sink sink{queue};
+    auto producer = std::thread{[&]{ produce(sink, nofSamples, kBlockSize); }};
+
+    auto buffer = std::vector<sample_t>(kBlockSize);
+    for(std::uint64_t consumed = 0; consumed < nofSamples; consumed += buffer.size())
+      {
+      queue.dequeue(buffer);
+      dab::benchmark::keep(buffer.back());
+      }
+
+    producer.join();
+    return nofSamples;
+    }
+
+  std::uint64_t run_pool(std::uint64_t iterations)
+    {
+    auto const nofSamples = iterations * kBlockSize;
+    dab::sample_block_pool pool{16, kBlockSize};
+    auto producer = std::thread{[&]{ produce(pool, nofSamples, kBlockSize); }};
+
+    for(std::uint64_t consumed = 0; consumed < nofSamples;)
+      {
+      auto block = pool.receive();
+      dab::benchmark::keep(block[block.size() - 1]);
+      consumed += block.size();
+      }
+
+    producer.join();
+    return nofSamples;
+    }
+
+  template<typename WaitStrategy>
+  std::uint64_t run_ring(std::uint64_t iterations)
+    {
+    auto const nofSamples = iterations * kBlockSize;
+    dab::basic_spsc_ring<sample_t, WaitStrategy> ring{16 * kBlockSize};
+    auto producer = std::thread{[&]{
+      produce(ring, nofSamples, kBlockSize);
+      ring.close();
+    }};
+
+    auto buffer = std::vector<sample_t>(kBlockSize);
+    while(auto const count = ring.read(buffer.data(), buffer.size()))
+      {
+      dab::benchmark::keep(buffer[count - 1]);
+      }
+
+    producer.join();
+    return nofSamples;
+    }
+
+  }
+
+int main(int argc, char * * argv)
+  {
+  auto runner = dab::benchmark::runner{};
+
+  runner.add("transport/sample_queue_t", run_queue);
+  runner.add("transport/sample_block_pool", run_pool);
+  runner.add("transport/sample_ring/spin", run_ring<dab::spin_wait>);
+  runner.add("transport/sample_ring/spin_then_park", run_ring<dab::spin_then_park_wait>);
+#if defined(__linux__)
+  runner.add("transport/sample_ring/futex", run_ring<dab::futex_wait>);
+#endif
+
+  return runner.run(argc, argv);
+  }
@@ -29,88 +29,315 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <dab/constants/channels.h>
 #include <dab/device/rtl_device.h>
+#include <dab/transport/block_pool.h>
 
-#include <fstream>
+#include <fcntl.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <future>
+#include <iomanip>
 #include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
 #include <thread>
 
-void dump(dab::sample_queue_t & queue, std::size_t nofSamples)
+namespace
   {
-  // Allocate a file to dump our samples into
-  auto && file = std::ofstream{"rtl_device.raw", std::ios::binary | std::ios::trunc};
 
-  // Allocate a block of memory, so we can dequeue faster
-  auto buffer = std::vector<dab::internal::sample_t>(4096);
+  // The device delivers 128 Ki samples (256 KiB) per callback, the writer flushes 16 of them at once
+  auto constexpr kSamplesPerBlock = std::size_t{128 * 1024};
+  auto constexpr kWriteSize = std::size_t{16 * kSamplesPerBlock * sizeof(dab::raw_sample)};
+  auto constexpr kWriteAlignment = std::size_t{4096};
 
-  (void)nofSamples;
+  std::atomic<bool> interrupted{};
 
- // Collect samples from the queue
- for(auto i = 0ull; i < nofSamples / 4096; ++i)
-   {
-   // Dequeue a whole block of samples
-   queue.dequeue(buffer);
+  struct options
+    {
+    std::string output{"rtl_device.raw"};
+    std::size_t index{};
+    dab::frequency frequency{dab::frequency::kHz(227360ull)};
+    dab::gain gain{30.0f};
+    std::chrono::seconds duration{};
+    std::size_t nofBlocks{64};
+    dab::thread_options threading{};
+    dab::rtl_transfers transfers{};
+    };
 
-   // We need to transform the samples back to unsigned chars, since the device normalizes them to floats
-   for(auto sample : buffer)
-     {
-     auto inphase =    static_cast<unsigned char>(sample.real() * 128 + 128);
-     auto quadrature = static_cast<unsigned char>(sample.imag() * 128 + 128);
+  // Collect raw blocks in a page aligned buffer and write it to the file in large chunks
+  struct writer
+    {
+    explicit writer(std::string const & filename)
+      : m_descriptor{::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)}
+      {
+      if(m_descriptor < 0)
+        {
+        throw std::system_error{errno, std::generic_category(), "Failed to open '" + filename + "'"};
+        }
 
-     file.write((char const *)&inphase, sizeof(inphase));
-     file.write((char const *)&quadrature, sizeof(quadrature));
-     }
-   }
+      void * buffer{};
+      if(posix_memalign(&buffer, kWriteAlignment, kWriteSize))
+        {
+        ::close(m_descriptor);
+        throw std::bad_alloc{};
+        }
+      m_buffer = static_cast<char *>(buffer);
+      }
 
- // We are done collecting, close the file
- file.close();
-  }
+    ~writer()
+      {
+      std::free(m_buffer);
+      ::close(m_descriptor);
+      }
 
-int main() try
-  {
-  using namespace dab::literals;
+    void append(void const * data, std::size_t length)
+      {
+      auto source = static_cast<char const *>(data);
+      while(length)
+        {
+        auto const chunk = std::min(length, kWriteSize - m_fill);
+        std::memcpy(m_buffer + m_fill, source, chunk);
+        m_fill += chunk;
+        source += chunk;
+        length -= chunk;
+
+        if(m_fill == kWriteSize)
+          {
+          flush();
+          }
+        }
+      }
+
+    void flush()
+      {
+      auto offset = std::size_t{};
+      while(offset < m_fill)
+        {
+        auto const written = ::write(m_descriptor, m_buffer + offset, m_fill - offset);
+        if(written < 0)
+          {
+          if(errno == EINTR)
+            {
+            continue;
+            }
+          throw std::system_error{errno, std::generic_category(), "Failed to write samples"};
+          }
+        offset += written;
+        }
+
+      m_written += m_fill;
+      m_fill = 0;
+      }
+
+    std::uint64_t written() const
+      {
+      return m_written;
+      }
+
+    private:
+      int m_descriptor;
+      char * m_buffer{};
+      std::size_t m_fill{};
+      std::uint64_t m_written{};
+    };
+
+  void usage(char const * name)
+    {
+    std::cerr << "usage: " << name << " [-o file] [-i index] [-c channel | -f kHz] [-g dB] [-d seconds] [-b blocks]\n"
+              << "       [-a cpu] [-r priority] [-m] [-t transfers]\n"
+              << "  -o  output file (default: rtl_device.raw)\n"
+              << "  -i  device index (default: 0)\n"
+              << "  -c  DAB channel label, e.g. 12C\n"
+              << "  -f  center frequency in kHz (default: 227360)\n"
+              << "  -g  gain in dB, the closest supported gain is used (default: 30)\n"
+              << "  -d  capture duration in seconds, 0 captures until interrupted (default: 0)\n"
+              << "  -b  number of 256 KiB blocks buffered between device and writer (default: 64)\n"
+              << "  -a  pin the USB reader thread to the given CPU, may be repeated\n"
+              << "  -r  run the USB reader thread with SCHED_FIFO at the given priority\n"
+              << "  -m  lock all memory, including the sample buffers, into RAM\n"
+              << "  -t  USB transfers, one of low_latency, balanced or high_throughput (default: balanced)\n";
+    }
+
+  dab::frequency channel_frequency(std::string const & label)
+    {
+    for(auto const & channel : dab::kChannels)
+      {
+      if(label == channel.label)
+        {
+        return channel.freq;
+        }
+      }
+
+    throw std::invalid_argument{"Unknown channel '" + label + "'"};
+    }
 
-  // Create a queue to hold out samples
-  auto && queue = dab::sample_queue_t{};
+  dab::rtl_transfers transfer_preset(std::string const & name)
+    {
+    if(name == "low_latency")
+      {
+      return dab::rtl_transfers::low_latency();
+      }
+    else if(name == "balanced")
+      {
+      return dab::rtl_transfers::balanced();
+      }
+    else if(name == "high_throughput")
+      {
+      return dab::rtl_transfers::high_throughput();
+      }
 
-  // Initialialize our RTL-SDR device
-  auto && device = dab::rtl_device{queue};
+    throw std::invalid_argument{"Unknown transfer preset '" + name + "'"};
+    }
 
-  // List the gains supported by our device
-  std::cout << "[libdabdevice] INFO: Supported gains (" << device.gains().size()<< "): ";
-  bool first = true;
-  for(auto && gain : device.gains())
+  options parse(int argc, char * * argv)
     {
-    if(!first)
+    auto parsed = options{};
+    auto option = 0;
+    parsed.threading.name = "rtl_dump-usb";
+
+    while((option = getopt(argc, argv, "o:i:c:f:g:d:b:a:r:mt:h")) != -1)
       {
-      std::cout << ", ";
+      switch(option)
+        {
+        case 'o':
+          parsed.output = optarg;
+          break;
+        case 'i':
+          parsed.index = std::stoul(optarg);
+          break;
+        case 'c':
+          parsed.frequency = channel_frequency(optarg);
+          break;
+        case 'f':
+          parsed.frequency = dab::frequency::kHz(std::stoull(optarg));
+          break;
+        case 'g':
+          parsed.gain = dab::gain{std::stof(optarg)};
+          break;
+        case 'd':
+          parsed.duration = std::chrono::seconds{std::stoul(optarg)};
+          break;
+        case 'b':
+          parsed.nofBlocks = std::stoul(optarg);
+          break;
+        case 'a':
+          parsed.threading.cpus.push_back(std::stoul(optarg));
+          break;
+        case 'r':
+          parsed.threading.scheduling = dab::scheduling_policy::fifo;
+          parsed.threading.priority = std::stoi(optarg);
+          break;
+        case 'm':
+          parsed.threading.lockMemory = true;
+          break;
+        case 't':
+          parsed.transfers = transfer_preset(optarg);
+          break;
+        default:
+          usage(argv[0]);
+          std::exit(option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
       }
 
-    std::cout << gain;
-    first = false;
+    return parsed;
     }
-  std::cout << '\n';
 
-  // Tune to channel 12C (the SRF DAB+ ensemble in Switzerland)
-  device.tune(227360_kHz);
+  }
+
+int main(int argc, char * * argv) try
+  {
+  auto const options = parse(argc, argv);
+
+  // Let the device convert straight into preallocated raw blocks
+  dab::raw_block_pool pool{options.nofBlocks, kSamplesPerBlock};
+  dab::rtl_device device{pool, options.index};
+  writer output{options.output};
+
+  device.tune(options.frequency);
+  device.gain(options.gain);
+  device.threading(options.threading);
+  device.transfers(options.transfers);
+
+  std::signal(SIGINT, [](int){ interrupted = true; });
+  std::signal(SIGTERM, [](int){ interrupted = true; });
 
-  // Set the gain to around 30 dB, the driver will make sure to find a suiting gain
-  device.gain(30_dB);
+  std::cout << "[libdabdevice] INFO: Capturing " << std::uint32_t(options.frequency) / 1000 << " kHz with a gain of "
+            << device.gain() << " into '" << options.output << "'\n";
 
-  // Start acquiring samples from the device
-  auto runner = std::async(std::launch::async, [&]{
-    std::cout << "[libdabdevice] INFO: Starting sample acquisition with a gain of " << device.gain() << '\n';
-    device.run();
+  // Write blocks on a thread of their own, so that a slow disk does not delay stopping the capture
+  auto const start = std::chrono::steady_clock::now();
+  auto const deadline = start + options.duration;
+  std::atomic<bool> stopped{};
+  auto runner = std::async(std::launch::async, [&]{ device.run(); });
+  auto writing = std::async(std::launch::async, [&]{
+    auto block = dab::raw_block_pool::block{};
+    while(!stopped)
+      {
+      if(pool.receive_for(block, std::chrono::milliseconds{100}))
+        {
+        output.append(block.data(), block.size() * sizeof(dab::raw_sample));
+        block.release();
+        }
+      }
+
+    // Drain the blocks that were acquired before the device stopped
+    while(pool.try_receive(block))
+      {
+      output.append(block.data(), block.size() * sizeof(dab::raw_sample));
+      block.release();
+      }
+    output.flush();
   });
 
-  // Start dumping the acquired samples into a file
-  dump(queue, 104857600);
+  auto const finished = [](std::future<void> const & task){
+    return task.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+  };
+
+  while(!interrupted && (!options.duration.count() || std::chrono::steady_clock::now() < deadline))
+    {
+    if(finished(runner) || finished(writing))
+      {
+      break;
+      }
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    }
 
-  // We have collected 200 MiB of samples, stop the device
   device.stop();
+  stopped = true;
+  runner.get();
+  writing.get();
+
+  auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  auto const captured = output.written() / sizeof(dab::raw_sample);
+  auto const stats = device.stats();
+  auto const dropped = stats.droppedSamples;
+  auto const total = captured + dropped;
+
+  std::cout << std::fixed << std::setprecision(2)
+            << "[libdabdevice] INFO: Captured " << captured << " samples (" << output.written() / 1048576.0 << " MiB) in "
+            << elapsed << " s, " << output.written() / 1048576.0 / elapsed << " MiB/s\n"
+            << "[libdabdevice] INFO: Dropped " << dropped << " samples ("
+            << (total ? 100.0 * dropped / total : 0.0) << " %)\n";
+
+  std::cout << "[libdabdevice] INFO: Handled " << stats.callbacks << " transfers in " << stats.avgCallback.count() / 1000.0
+            << " us on average (min " << stats.minCallback.count() / 1000.0 << " us, max " << stats.maxCallback.count() / 1000.0
+            << " us)\n";
+
   }
-catch(std::runtime_error const & e)
+catch(std::exception const & e)
   {
   std::cerr << "[libdabdevice] FATAL: " << e.what() << std::endl;
+  return EXIT_FAILURE;
   }
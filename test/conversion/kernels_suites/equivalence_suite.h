@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_CONVERSION_KERNELS__EQUIVALENCE_SUITE
+#define DABDEVICE_TEST_CONVERSION_KERNELS__EQUIVALENCE_SUITE
+
+#include <dab/conversion/kernels.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace conversion
+      {
+
+      namespace kernels
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(equivalence_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_scalar_kernel_matches_reference),
+              LOCAL_TEST(test_supported_kernels_match_scalar_for_all_pairs),
+              LOCAL_TEST(test_supported_kernels_match_scalar_for_all_lengths),
+              LOCAL_TEST(test_supported_kernels_match_scalar_when_unaligned),
+              LOCAL_TEST(test_best_isa_is_supported),
+              LOCAL_TEST(test_dispatched_conversion_matches_scalar),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_scalar_kernel_matches_reference()
+            {
+            auto const raw = all_pairs();
+            auto converted = std::vector<dab::internal::sample_t>(raw.size() / 2);
+            dab::conversion::convert_scalar(raw.data(), converted.size(), converted.data());
+
+            auto reference = std::vector<dab::internal::sample_t>(raw.size() / 2);
+            for(std::size_t idx = 0; idx < reference.size(); ++idx)
+              {
+              reference[idx] = dab::internal::sample_t{float(raw[2 * idx] - 128) / 128, float(raw[2 * idx + 1] - 128) / 128};
+              }
+
+            ASSERT(identical(reference, converted));
+            }
+
+          void test_supported_kernels_match_scalar_for_all_pairs()
+            {
+            auto const raw = all_pairs();
+            auto const reference = scalar(raw.data(), raw.size() / 2);
+
+            for(auto const target : kAllIsas)
+              {
+              if(!dab::conversion::supported(target))
+                {
+                continue;
+                }
+
+              auto converted = std::vector<dab::internal::sample_t>(reference.size());
+              dab::conversion::kernel_for(target)(raw.data(), converted.size(), converted.data());
+              ASSERTM(name(target), identical(reference, converted));
+              }
+            }
+
+          void test_supported_kernels_match_scalar_for_all_lengths()
+            {
+            auto const raw = all_pairs();
+
+            for(std::size_t length = 0; length < 200; ++length)
+              {
+              auto const reference = scalar(raw.data() + 2 * length, length);
+
+              for(auto const target : kAllIsas)
+                {
+                if(!dab::conversion::supported(target))
+                  {
+                  continue;
+                  }
+
+                auto converted = std::vector<dab::internal::sample_t>(length + 1, dab::internal::sample_t{42, 42});
+                dab::conversion::kernel_for(target)(raw.data() + 2 * length, length, converted.data());
+                ASSERTM(name(target), identical(reference, {converted.begin(), converted.begin() + length}));
+                ASSERTM(name(target), converted.back() == (dab::internal::sample_t{42, 42}));
+                }
+              }
+            }
+
+          void test_supported_kernels_match_scalar_when_unaligned()
+            {
+            auto const raw = all_pairs();
+            auto const nofSamples = std::size_t{1021};
+
+            for(std::size_t offset = 1; offset < 64; offset += 7)
+              {
+              auto const reference = scalar(raw.data() + offset, nofSamples);
+
+              for(auto const target : kAllIsas)
+                {
+                if(!dab::conversion::supported(target))
+                  {
+                  continue;
+                  }
+
+                auto storage = std::vector<dab::internal::sample_t>(nofSamples + 1);
+                auto destination = reinterpret_cast<dab::internal::sample_t *>(reinterpret_cast<float *>(storage.data()) + 1);
+                dab::conversion::kernel_for(target)(raw.data() + offset, nofSamples, destination);
+                ASSERTM(name(target), identical(reference, {destination, destination + nofSamples}));
+                }
+              }
+            }
+
+          void test_best_isa_is_supported()
+            {
+            ASSERT(dab::conversion::supported(dab::conversion::best_isa()));
+            }
+
+          void test_dispatched_conversion_matches_scalar()
+            {
+            auto const raw = all_pairs();
+            auto const reference = scalar(raw.data(), raw.size() / 2);
+
+            auto converted = std::vector<dab::internal::sample_t>(reference.size());
+            dab::conversion::convert(raw.data(), converted.size(), converted.data());
+
+            ASSERT(identical(reference, converted));
+            }
+
+          private:
+            static dab::conversion::isa constexpr kAllIsas[] = {
+              dab::conversion::isa::scalar,
+              dab::conversion::isa::sse2,
+              dab::conversion::isa::avx2,
+              dab::conversion::isa::avx512,
+            };
+
+            static std::vector<std::uint8_t> all_pairs()
+              {
+              auto raw = std::vector<std::uint8_t>{};
+              raw.reserve(2 * 65536);
+              for(auto inphase = 0; inphase < 256; ++inphase)
+                {
+                for(auto quadrature = 0; quadrature < 256; ++quadrature)
+                  {
+                  raw.push_back(static_cast<std::uint8_t>(inphase));
+                  raw.push_back(static_cast<std::uint8_t>(quadrature));
+                  }
+                }
+              return raw;
+              }
+
+            static std::vector<dab::internal::sample_t> scalar(std::uint8_t const * raw, std::size_t nofSamples)
+              {
+              auto result = std::vector<dab::internal::sample_t>(nofSamples);
+              dab::conversion::convert_scalar(raw, nofSamples, result.data());
+              return result;
+              }
+
+            static bool identical(std::vector<dab::internal::sample_t> const & lhs, std::vector<dab::internal::sample_t> const & rhs)
+              {
+              return lhs.size() == rhs.size() && !std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(dab::internal::sample_t));
+              }
+
+            static char const * name(dab::conversion::isa const target)
+              {
+              switch(target)
+                {
+                case dab::conversion::isa::sse2:
+                  return "SSE2 kernel differs from the scalar kernel";
+                case dab::conversion::isa::avx2:
+                  return "AVX2 kernel differs from the scalar kernel";
+                case dab::conversion::isa::avx512:
+                  return "AVX-512 kernel differs from the scalar kernel";
+                default:
+                  return "Scalar kernel differs from itself";
+                }
+              }
+          };
+
+        constexpr dab::conversion::isa equivalence_tests::kAllIsas[];
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
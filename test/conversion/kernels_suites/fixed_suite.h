@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_CONVERSION_KERNELS__FIXED_SUITE
+#define DABDEVICE_TEST_CONVERSION_KERNELS__FIXED_SUITE
+
+#include <dab/conversion/kernels.h>
+#include <dab/types/fixed_sample.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace conversion
+      {
+
+      namespace kernels
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(fixed_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_fixed_scalar_kernel_is_scaled_float_kernel),
+              LOCAL_TEST(test_fixed_kernels_match_scalar_for_all_pairs),
+              LOCAL_TEST(test_fixed_kernels_match_scalar_for_all_lengths),
+              LOCAL_TEST(test_dispatched_fixed_conversion_matches_scalar),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_fixed_scalar_kernel_is_scaled_float_kernel()
+            {
+            auto const raw = all_pairs();
+            auto const fixed = scalar(raw.data(), raw.size() / 2);
+            auto floating = std::vector<dab::internal::sample_t>(fixed.size());
+            dab::conversion::convert_scalar(raw.data(), floating.size(), floating.data());
+
+            auto matches = true;
+            for(std::size_t idx = 0; idx < fixed.size(); ++idx)
+              {
+              matches &= fixed[idx].real() == floating[idx].real() * 32768;
+              matches &= fixed[idx].imag() == floating[idx].imag() * 32768;
+              }
+
+            ASSERT(matches);
+            }
+
+          void test_fixed_kernels_match_scalar_for_all_pairs()
+            {
+            auto const raw = all_pairs();
+            auto const reference = scalar(raw.data(), raw.size() / 2);
+
+            for(auto const target : kAllIsas)
+              {
+              if(!dab::conversion::supported(target))
+                {
+                continue;
+                }
+
+              auto converted = std::vector<dab::fixed_sample>(reference.size());
+              dab::conversion::fixed_kernel_for(target)(raw.data(), converted.size(), converted.data());
+              ASSERTM(name(target), reference == converted);
+              }
+            }
+
+          void test_fixed_kernels_match_scalar_for_all_lengths()
+            {
+            auto const raw = all_pairs();
+
+            for(std::size_t length = 0; length < 100; ++length)
+              {
+              auto const reference = scalar(raw.data() + 2 * length + 1, length);
+
+              for(auto const target : kAllIsas)
+                {
+                if(!dab::conversion::supported(target))
+                  {
+                  continue;
+                  }
+
+                auto converted = std::vector<dab::fixed_sample>(length + 1, dab::fixed_sample{42, 42});
+                dab::conversion::fixed_kernel_for(target)(raw.data() + 2 * length + 1, length, converted.data());
+                ASSERTM(name(target), reference == std::vector<dab::fixed_sample>(converted.begin(), converted.begin() + length));
+                ASSERTM(name(target), converted.back() == (dab::fixed_sample{42, 42}));
+                }
+              }
+            }
+
+          void test_dispatched_fixed_conversion_matches_scalar()
+            {
+            auto const raw = all_pairs();
+            auto const reference = scalar(raw.data(), raw.size() / 2);
+
+            auto converted = std::vector<dab::fixed_sample>(reference.size());
+            dab::conversion::convert(raw.data(), converted.size(), converted.data());
+
+            ASSERT(reference == converted);
+            }
+
+          private:
+            static dab::conversion::isa constexpr kAllIsas[] = {
+              dab::conversion::isa::scalar,
+              dab::conversion::isa::sse2,
+              dab::conversion::isa::avx2,
+              dab::conversion::isa::avx512,
+            };
+
+            static std::vector<std::uint8_t> all_pairs()
+              {
+              auto raw = std::vector<std::uint8_t>{};
+              raw.reserve(2 * 65536);
+              for(auto inphase = 0; inphase < 256; ++inphase)
+                {
+                for(auto quadrature = 0; quadrature < 256; ++quadrature)
+                  {
+                  raw.push_back(static_cast<std::uint8_t>(inphase));
+                  raw.push_back(static_cast<std::uint8_t>(quadrature));
+                  }
+                }
+              return raw;
+              }
+
+            static std::vector<dab::fixed_sample> scalar(std::uint8_t const * raw, std::size_t nofSamples)
+              {
+              auto result = std::vector<dab::fixed_sample>(nofSamples);
+              dab::conversion::convert_fixed_scalar(raw, nofSamples, result.data());
+              return result;
+              }
+
+            static char const * name(dab::conversion::isa const target)
+              {
+              switch(target)
+                {
+                case dab::conversion::isa::sse2:
+                  return "SSE2 fixed-point kernel differs from the scalar kernel";
+                case dab::conversion::isa::avx2:
+                case dab::conversion::isa::avx512:
+                  return "AVX2 fixed-point kernel differs from the scalar kernel";
+                default:
+                  return "Scalar fixed-point kernel differs from itself";
+                }
+              }
+          };
+
+        constexpr dab::conversion::isa fixed_tests::kAllIsas[];
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
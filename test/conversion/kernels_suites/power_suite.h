@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_CONVERSION_KERNELS__POWER_SUITE
+#define DABDEVICE_TEST_CONVERSION_KERNELS__POWER_SUITE
+
+#include <dab/conversion/power.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace conversion
+      {
+
+      namespace kernels
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(power_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_zero_point_has_no_power),
+              LOCAL_TEST(test_full_scale_has_unit_power_per_component),
+              LOCAL_TEST(test_supported_kernels_match_scalar_for_all_lengths),
+              LOCAL_TEST(test_supported_kernels_do_not_overflow),
+              LOCAL_TEST(test_empty_block_has_no_power),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_zero_point_has_no_power()
+            {
+            auto const raw = std::vector<std::uint8_t>(1024, 128);
+            ASSERT_EQUAL_DELTA(0.0, dab::conversion::mean_power(raw.data(), raw.size() / 2), 1e-12);
+            }
+
+          void test_full_scale_has_unit_power_per_component()
+            {
+            auto const raw = std::vector<std::uint8_t>{0, 128, 128, 0, 0, 0, 128, 128};
+            ASSERT_EQUAL_DELTA(1.0, dab::conversion::mean_power(raw.data(), raw.size() / 2), 1e-12);
+            }
+
+          void test_supported_kernels_match_scalar_for_all_lengths()
+            {
+            auto raw = std::vector<std::uint8_t>(2 * 200 + 1);
+            for(std::size_t idx = 0; idx < raw.size(); ++idx)
+              {
+              raw[idx] = static_cast<std::uint8_t>(idx * 37 + 11);
+              }
+
+            for(std::size_t length = 0; length < 200; ++length)
+              {
+              auto const reference = dab::conversion::energy_scalar(raw.data() + 1, length);
+
+              for(auto const target : kAllIsas)
+                {
+                if(dab::conversion::supported(target))
+                  {
+                  ASSERT_EQUAL(reference, dab::conversion::energy_kernel_for(target)(raw.data() + 1, length));
+                  }
+                }
+              }
+            }
+
+          void test_supported_kernels_do_not_overflow()
+            {
+            auto const nofSamples = std::size_t{300000};
+            auto const raw = std::vector<std::uint8_t>(2 * nofSamples, 0);
+            auto const expected = std::uint64_t{2 * nofSamples * 128 * 128};
+
+            for(auto const target : kAllIsas)
+              {
+              if(dab::conversion::supported(target))
+                {
+                ASSERT_EQUAL(expected, dab::conversion::energy_kernel_for(target)(raw.data(), nofSamples));
+                }
+              }
+            }
+
+          void test_empty_block_has_no_power()
+            {
+            ASSERT_EQUAL_DELTA(0.0, dab::conversion::mean_power(nullptr, 0), 1e-12);
+            }
+
+          private:
+            static dab::conversion::isa constexpr kAllIsas[] = {
+              dab::conversion::isa::scalar,
+              dab::conversion::isa::sse2,
+              dab::conversion::isa::avx2,
+              dab::conversion::isa::avx512,
+            };
+          };
+
+        constexpr dab::conversion::isa power_tests::kAllIsas[];
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
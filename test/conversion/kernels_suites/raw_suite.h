@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_CONVERSION_KERNELS__RAW_SUITE
+#define DABDEVICE_TEST_CONVERSION_KERNELS__RAW_SUITE
+
+#include <dab/conversion/kernels.h>
+#include <dab/types/raw_sample.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace conversion
+      {
+
+      namespace kernels
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(raw_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_raw_samples_convert_like_bytes),
+              LOCAL_TEST(test_chunked_conversion_matches_whole_conversion),
+              LOCAL_TEST(test_chunks_do_not_exceed_chunk_size),
+              LOCAL_TEST(test_chunked_conversion_of_nothing_consumes_nothing),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_raw_samples_convert_like_bytes()
+            {
+            dab::raw_sample const raw[] = {{0, 255}, {128, 64}};
+            dab::internal::sample_t converted[2]{};
+            dab::conversion::convert(raw, 2, converted);
+
+            ASSERT_EQUAL((dab::internal::sample_t{-1.0f, 127.0f / 128}), converted[0]);
+            ASSERT_EQUAL((dab::internal::sample_t{0.0f, -0.5f}), converted[1]);
+            }
+
+          void test_chunked_conversion_matches_whole_conversion()
+            {
+            auto const raw = samples(3 * dab::conversion::kChunkSize + 17);
+            auto whole = std::vector<dab::internal::sample_t>(raw.size());
+            dab::conversion::convert(raw.data(), raw.size(), whole.data());
+
+            auto chunked = std::vector<dab::internal::sample_t>{};
+            dab::conversion::convert_chunked(raw.data(), raw.size(), [&](dab::internal::sample_t const * chunk, std::size_t count){
+              chunked.insert(chunked.end(), chunk, chunk + count);
+            });
+
+            ASSERT(whole == chunked);
+            }
+
+          void test_chunks_do_not_exceed_chunk_size()
+            {
+            auto const raw = samples(2 * dab::conversion::kChunkSize + 1);
+            auto sizes = std::vector<std::size_t>{};
+            dab::conversion::convert_chunked(raw.data(), raw.size(), [&](dab::internal::sample_t const *, std::size_t count){
+              sizes.push_back(count);
+            });
+
+            ASSERT((std::vector<std::size_t>{dab::conversion::kChunkSize, dab::conversion::kChunkSize, 1}) == sizes);
+            }
+
+          void test_chunked_conversion_of_nothing_consumes_nothing()
+            {
+            auto calls = 0;
+            dab::conversion::convert_chunked(nullptr, 0, [&](dab::internal::sample_t const *, std::size_t){ ++calls; });
+
+            ASSERT_EQUAL(0, calls);
+            }
+
+          private:
+            static std::vector<dab::raw_sample> samples(std::size_t count)
+              {
+              auto raw = std::vector<dab::raw_sample>(count);
+              for(std::size_t index = 0; index < count; ++index)
+                {
+                raw[index] = dab::raw_sample{std::uint8_t(index), std::uint8_t(index * 3)};
+                }
+              return raw;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_CONVERSION_LOOKUP_TABLE__CONVERTER_SUITE
+#define DABDEVICE_TEST_CONVERSION_LOOKUP_TABLE__CONVERTER_SUITE
+
+#include <dab/conversion/converter.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace conversion
+      {
+
+      namespace lookup_table
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(converter_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_converter_is_uncalibrated_by_default),
+              LOCAL_TEST(test_fixed_calibration_is_applied),
+              LOCAL_TEST(test_frequency_change_rebuilds_calibration),
+              LOCAL_TEST(test_gain_change_rebuilds_calibration),
+              LOCAL_TEST(test_empty_source_removes_calibration),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_converter_is_uncalibrated_by_default()
+            {
+            dab::conversion::converter converter{};
+
+            ASSERT(!converter.calibrated());
+            ASSERT_EQUAL(0.5f, convert(converter).real());
+            }
+
+          void test_fixed_calibration_is_applied()
+            {
+            dab::conversion::converter converter{};
+            converter.calibrate(dab::conversion::fixed({0.5f, 0.0f, 1.0f}));
+
+            ASSERT(converter.calibrated());
+            ASSERT_EQUAL(0.0f, convert(converter).real());
+            }
+
+          void test_frequency_change_rebuilds_calibration()
+            {
+            dab::conversion::converter converter{};
+            converter.calibrate([](dab::frequency frequency, dab::gain){
+              return dab::conversion::calibration{std::uint32_t(frequency) ? 0.25f : 0.0f, 0.0f, 1.0f};
+            });
+
+            ASSERT_EQUAL(0.5f, convert(converter).real());
+            converter.update(dab::frequency{227360000});
+            ASSERT_EQUAL(0.25f, convert(converter).real());
+            }
+
+          void test_gain_change_rebuilds_calibration()
+            {
+            dab::conversion::converter converter{};
+            converter.calibrate([](dab::frequency, dab::gain gain){
+              return dab::conversion::calibration{gain.value() / 100, 0.0f, 1.0f};
+            });
+
+            converter.update(dab::gain{25.0f});
+            ASSERT_EQUAL(0.25f, convert(converter).real());
+            }
+
+          void test_empty_source_removes_calibration()
+            {
+            dab::conversion::converter converter{};
+            converter.calibrate(dab::conversion::fixed({0.5f, 0.0f, 1.0f}));
+            converter.calibrate(dab::conversion::calibration_source{});
+
+            ASSERT(!converter.calibrated());
+            ASSERT_EQUAL(0.5f, convert(converter).real());
+            }
+
+          private:
+            static dab::internal::sample_t convert(dab::conversion::converter const & converter)
+              {
+              std::uint8_t const raw[] = {192, 128};
+              auto sample = dab::internal::sample_t{};
+              converter.convert(raw, 1, &sample);
+              return sample;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
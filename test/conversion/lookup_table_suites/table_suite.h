@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_CONVERSION_LOOKUP_TABLE__TABLE_SUITE
+#define DABDEVICE_TEST_CONVERSION_LOOKUP_TABLE__TABLE_SUITE
+
+#include <dab/conversion/kernels.h>
+#include <dab/conversion/lookup_table.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace conversion
+      {
+
+      namespace lookup_table
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(table_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_default_calibration_matches_kernel),
+              LOCAL_TEST(test_inphase_and_quadrature_are_not_swapped),
+              LOCAL_TEST(test_dc_offset_is_removed),
+              LOCAL_TEST(test_quadrature_gain_is_applied_after_offset),
+              LOCAL_TEST(test_table_remembers_its_calibration),
+              LOCAL_TEST(test_default_calibration_matches_fixed_kernel),
+              LOCAL_TEST(test_fixed_entries_are_calibrated),
+              LOCAL_TEST(test_fixed_entries_saturate),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_default_calibration_matches_kernel()
+            {
+            auto raw = std::vector<std::uint8_t>{};
+            for(auto value = 0; value < 2 * 65536; ++value)
+              {
+              raw.push_back(static_cast<std::uint8_t>(value % 256 ^ value / 512));
+              }
+
+            auto expected = std::vector<dab::internal::sample_t>(65536);
+            dab::conversion::convert_scalar(raw.data(), expected.size(), expected.data());
+
+            auto actual = std::vector<dab::internal::sample_t>(65536);
+            dab::conversion::lookup_table{dab::conversion::calibration{}}.convert(raw.data(), actual.size(), actual.data());
+
+            ASSERT(!std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(dab::internal::sample_t)));
+            }
+
+          void test_inphase_and_quadrature_are_not_swapped()
+            {
+            std::uint8_t const raw[] = {255, 0};
+            auto const sample = dab::conversion::lookup_table{dab::conversion::calibration{}}(raw);
+
+            ASSERT_EQUAL(127.0f / 128, sample.real());
+            ASSERT_EQUAL(-1.0f, sample.imag());
+            }
+
+          void test_dc_offset_is_removed()
+            {
+            std::uint8_t const raw[] = {144, 112};
+            auto const table = dab::conversion::lookup_table{{0.125f, -0.125f, 1.0f}};
+            auto const sample = table(raw);
+
+            ASSERT_EQUAL(0.0f, sample.real());
+            ASSERT_EQUAL(0.0f, sample.imag());
+            }
+
+          void test_quadrature_gain_is_applied_after_offset()
+            {
+            std::uint8_t const raw[] = {192, 192};
+            auto const table = dab::conversion::lookup_table{{0.0f, 0.25f, 2.0f}};
+            auto const sample = table(raw);
+
+            ASSERT_EQUAL(0.5f, sample.real());
+            ASSERT_EQUAL(0.5f, sample.imag());
+            }
+
+          void test_table_remembers_its_calibration()
+            {
+            auto const calibration = dab::conversion::calibration{0.5f, 0.25f, 1.5f};
+
+            ASSERT(dab::conversion::lookup_table{calibration}.calibration() == calibration);
+            }
+
+          void test_default_calibration_matches_fixed_kernel()
+            {
+            auto raw = std::vector<std::uint8_t>{};
+            for(auto value = 0; value < 2 * 65536; ++value)
+              {
+              raw.push_back(static_cast<std::uint8_t>(value % 256 ^ value / 512));
+              }
+
+            auto expected = std::vector<dab::fixed_sample>(65536);
+            dab::conversion::convert_fixed_scalar(raw.data(), expected.size(), expected.data());
+
+            auto actual = std::vector<dab::fixed_sample>(65536);
+            dab::conversion::lookup_table{dab::conversion::calibration{}}.convert(raw.data(), actual.size(), actual.data());
+
+            ASSERT(expected == actual);
+            }
+
+          void test_fixed_entries_are_calibrated()
+            {
+            std::uint8_t const raw[] = {192, 192};
+            auto const table = dab::conversion::lookup_table{{0.0f, 0.25f, 2.0f}};
+            auto sample = dab::fixed_sample{};
+            table.convert(raw, 1, &sample);
+
+            ASSERT_EQUAL(16384, sample.real());
+            ASSERT_EQUAL(16384, sample.imag());
+            }
+
+          void test_fixed_entries_saturate()
+            {
+            std::uint8_t const raw[] = {255, 0};
+            auto const table = dab::conversion::lookup_table{{-0.5f, 0.5f, 1.0f}};
+            auto sample = dab::fixed_sample{};
+            table.convert(raw, 1, &sample);
+
+            ASSERT_EQUAL(32767, sample.real());
+            ASSERT_EQUAL(-32768, sample.imag());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,599 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fake_rtlsdr.h"
+#include "rtl-sdr.h"
+
+#include <dab/device/pacer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace
+  {
+
+  // The states of the acquisition loop, named like their counterparts in librtlsdr
+  enum struct async_status : int
+    {
+    inactive,
+    running,
+    canceling,
+    };
+
+  struct state
+    {
+    std::mutex mutex{};
+    fake_rtlsdr::configuration configuration{};
+    std::vector<unsigned char> recording{};
+    fake_rtlsdr::statistics statistics{};
+    };
+
+  state & global()
+    {
+    static state instance{};
+    return instance;
+    }
+
+  fake_rtlsdr::configuration current_configuration()
+    {
+    std::lock_guard<std::mutex> lock{global().mutex};
+    return global().configuration;
+    }
+
+  template<typename Update>
+  void record(Update update)
+    {
+    std::lock_guard<std::mutex> lock{global().mutex};
+    update(global().statistics);
+    }
+
+  void copy_string(char * target, std::string const & source)
+    {
+    if(target)
+      {
+      auto const length = std::min<std::size_t>(source.size(), 255);
+      std::memcpy(target, source.data(), length);
+      target[length] = '\0';
+      }
+    }
+
+  // librtlsdr only accepts sample rates its resampler can produce
+  bool is_valid_sample_rate(std::uint32_t rate)
+    {
+    return (rate > 225000 && rate <= 300000) || (rate > 900000 && rate <= 3200000);
+    }
+
+  }
+
+struct rtlsdr_dev
+  {
+  rtlsdr_dev(std::uint32_t index, fake_rtlsdr::configuration configuration) :
+    index{index},
+    configuration{std::move(configuration)}
+    {
+
+    }
+
+  std::uint32_t const index;
+  fake_rtlsdr::configuration const configuration;
+  std::atomic<async_status> status{async_status::inactive};
+  std::uint32_t sampleRate{};
+  std::uint32_t centerFrequency{};
+  int frequencyCorrection{};
+  int gain{};
+  int gainMode{};
+  int agcMode{};
+  std::uint64_t position{};
+  };
+
+namespace fake_rtlsdr
+  {
+
+  void configure(configuration const & configuration)
+    {
+    auto recording = std::vector<unsigned char>{};
+
+    if(!configuration.recording.empty())
+      {
+      std::ifstream file{configuration.recording, std::ios::binary};
+      if(!file)
+        {
+        throw std::ios::failure{"Failed to open recording '" + configuration.recording + "'."};
+        }
+
+      recording.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+      if(recording.empty())
+        {
+        throw std::ios::failure{"Recording '" + configuration.recording + "' is empty."};
+        }
+      }
+
+    std::lock_guard<std::mutex> lock{global().mutex};
+    global().configuration = configuration;
+    global().recording = std::move(recording);
+    global().statistics = statistics{};
+    }
+
+  statistics stats()
+    {
+    std::lock_guard<std::mutex> lock{global().mutex};
+    return global().statistics;
+    }
+
+  }
+
+namespace
+  {
+
+  bool has_recording()
+    {
+    std::lock_guard<std::mutex> lock{global().mutex};
+    return !global().recording.empty();
+    }
+
+  bool on_air(rtlsdr_dev_t * dev)
+    {
+    auto const & carriers = dev->configuration.carriers;
+    return carriers.empty() || std::find(carriers.begin(), carriers.end(), dev->centerFrequency) != carriers.end();
+    }
+
+  // Fill the buffer with the next bytes of the recording, or of the ramp if there is none
+  void fill(rtlsdr_dev_t * dev, unsigned char * buffer, std::size_t length)
+    {
+    std::lock_guard<std::mutex> lock{global().mutex};
+    auto const & recording = global().recording;
+
+    if(!on_air(dev))
+      {
+      for(std::size_t index = 0; index < length; ++index)
+        {
+        buffer[index] = static_cast<unsigned char>(127 + (dev->position + index) % 3);
+        }
+      }
+    else if(recording.empty())
+      {
+      for(std::size_t index = 0; index < length; ++index)
+        {
+        buffer[index] = static_cast<unsigned char>(dev->position + index);
+        }
+      }
+    else
+      {
+      for(std::size_t copied = 0; copied < length;)
+        {
+        auto const offset = (dev->position + copied) % recording.size();
+        auto const count = std::min(length - copied, recording.size() - offset);
+        std::memcpy(buffer + copied, recording.data() + offset, count);
+        copied += count;
+        }
+      }
+
+    dev->position += length;
+    }
+
+  }
+
+extern "C"
+  {
+
+  uint32_t rtlsdr_get_device_count(void)
+    {
+    return current_configuration().nofDevices;
+    }
+
+  const char * rtlsdr_get_device_name(uint32_t index)
+    {
+    return index < rtlsdr_get_device_count() ? "Generic RTL2832U OEM" : "";
+    }
+
+  int rtlsdr_get_device_usb_strings(uint32_t index, char * manufact, char * product, char * serial)
+    {
+    auto const configuration = current_configuration();
+    if(index >= configuration.nofDevices)
+      {
+      return -1;
+      }
+
+    copy_string(manufact, configuration.manufacturer);
+    copy_string(product, configuration.product);
+    copy_string(serial, configuration.serial);
+    return 0;
+    }
+
+  int rtlsdr_get_index_by_serial(const char * serial)
+    {
+    if(!serial)
+      {
+      return -1;
+      }
+
+    auto const configuration = current_configuration();
+    if(!configuration.nofDevices)
+      {
+      return -2;
+      }
+
+    return configuration.serial == serial ? 0 : -3;
+    }
+
+  int rtlsdr_open(rtlsdr_dev_t * * dev, uint32_t index)
+    {
+    auto const configuration = current_configuration();
+    if(!dev || index >= configuration.nofDevices)
+      {
+      return -1;
+      }
+
+    std::this_thread::sleep_for(configuration.openDelay);
+    *dev = new rtlsdr_dev{index, configuration};
+    record([](fake_rtlsdr::statistics & statistics){ ++statistics.opened; });
+    return 0;
+    }
+
+  int rtlsdr_close(rtlsdr_dev_t * dev)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    delete dev;
+    record([](fake_rtlsdr::statistics & statistics){ ++statistics.closed; });
+    return 0;
+    }
+
+  int rtlsdr_set_xtal_freq(rtlsdr_dev_t * dev, uint32_t, uint32_t)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_get_xtal_freq(rtlsdr_dev_t * dev, uint32_t * rtl_freq, uint32_t * tuner_freq)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    if(rtl_freq)
+      {
+      *rtl_freq = 28800000;
+      }
+
+    if(tuner_freq)
+      {
+      *tuner_freq = 28800000;
+      }
+
+    return 0;
+    }
+
+  int rtlsdr_get_usb_strings(rtlsdr_dev_t * dev, char * manufact, char * product, char * serial)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    copy_string(manufact, dev->configuration.manufacturer);
+    copy_string(product, dev->configuration.product);
+    copy_string(serial, dev->configuration.serial);
+    return 0;
+    }
+
+  int rtlsdr_set_center_freq(rtlsdr_dev_t * dev, uint32_t freq)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    std::this_thread::sleep_for(dev->configuration.tuningDelay);
+    dev->centerFrequency = freq;
+    record([](fake_rtlsdr::statistics & statistics){ ++statistics.tunes; });
+    return 0;
+    }
+
+  uint32_t rtlsdr_get_center_freq(rtlsdr_dev_t * dev)
+    {
+    return dev ? dev->centerFrequency : 0;
+    }
+
+  int rtlsdr_set_freq_correction(rtlsdr_dev_t * dev, int ppm)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    if(dev->frequencyCorrection == ppm)
+      {
+      return -2;
+      }
+
+    dev->frequencyCorrection = ppm;
+    return 0;
+    }
+
+  int rtlsdr_get_freq_correction(rtlsdr_dev_t * dev)
+    {
+    return dev ? dev->frequencyCorrection : 0;
+    }
+
+  enum rtlsdr_tuner rtlsdr_get_tuner_type(rtlsdr_dev_t * dev)
+    {
+    return dev ? RTLSDR_TUNER_R820T : RTLSDR_TUNER_UNKNOWN;
+    }
+
+  int rtlsdr_get_tuner_gains(rtlsdr_dev_t * dev, int * gains)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    auto const & supported = dev->configuration.gains;
+    if(gains)
+      {
+      std::copy(supported.begin(), supported.end(), gains);
+      }
+
+    return static_cast<int>(supported.size());
+    }
+
+  int rtlsdr_set_tuner_gain(rtlsdr_dev_t * dev, int gain)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    // Like the R820T driver, settle on the closest supported gain
+    auto const & supported = dev->configuration.gains;
+    auto const closest = std::min_element(supported.begin(), supported.end(), [gain](int lhs, int rhs){
+      return std::abs(lhs - gain) < std::abs(rhs - gain);
+    });
+
+    dev->gain = closest == supported.end() ? gain : *closest;
+    return 0;
+    }
+
+  int rtlsdr_set_tuner_bandwidth(rtlsdr_dev_t * dev, uint32_t)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_get_tuner_gain(rtlsdr_dev_t * dev)
+    {
+    return dev ? dev->gain : 0;
+    }
+
+  int rtlsdr_set_tuner_if_gain(rtlsdr_dev_t * dev, int, int)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_set_tuner_gain_mode(rtlsdr_dev_t * dev, int manual)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    dev->gainMode = manual;
+    return 0;
+    }
+
+  int rtlsdr_set_sample_rate(rtlsdr_dev_t * dev, uint32_t rate)
+    {
+    if(!dev || !is_valid_sample_rate(rate))
+      {
+      return -22;
+      }
+
+    dev->sampleRate = rate;
+    return 0;
+    }
+
+  uint32_t rtlsdr_get_sample_rate(rtlsdr_dev_t * dev)
+    {
+    return dev ? dev->sampleRate : 0;
+    }
+
+  int rtlsdr_set_testmode(rtlsdr_dev_t * dev, int)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_set_agc_mode(rtlsdr_dev_t * dev, int on)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    dev->agcMode = on;
+    return 0;
+    }
+
+  int rtlsdr_set_direct_sampling(rtlsdr_dev_t * dev, int)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_get_direct_sampling(rtlsdr_dev_t * dev)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_set_offset_tuning(rtlsdr_dev_t * dev, int)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_get_offset_tuning(rtlsdr_dev_t * dev)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_reset_buffer(rtlsdr_dev_t * dev)
+    {
+    return dev ? 0 : -1;
+    }
+
+  int rtlsdr_read_sync(rtlsdr_dev_t * dev, void * buf, int len, int * n_read)
+    {
+    if(!dev || !buf || len < 0)
+      {
+      return -1;
+      }
+
+    // libusb refuses synchronous bulk transfers while the asynchronous ones are in flight
+    if(dev->status.load(std::memory_order_acquire) != async_status::inactive)
+      {
+      return -2;
+      }
+
+    fill(dev, static_cast<unsigned char *>(buf), static_cast<std::size_t>(len));
+    if(n_read)
+      {
+      *n_read = len;
+      }
+
+    record([&](fake_rtlsdr::statistics & statistics){
+      ++statistics.buffers;
+      statistics.bytes += static_cast<std::uint64_t>(len);
+    });
+    return 0;
+    }
+
+  int rtlsdr_wait_async(rtlsdr_dev_t * dev, rtlsdr_read_async_cb_t cb, void * ctx)
+    {
+    return rtlsdr_read_async(dev, cb, ctx, 0, 0);
+    }
+
+  int rtlsdr_read_async(rtlsdr_dev_t * dev, rtlsdr_read_async_cb_t cb, void * ctx, uint32_t buf_num, uint32_t buf_len)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    auto expected = async_status::inactive;
+    if(!dev->status.compare_exchange_strong(expected, async_status::running))
+      {
+      return -2;
+      }
+
+    auto const & configuration = dev->configuration;
+    auto const bufferCount = buf_num ? buf_num : configuration.bufferCount;
+    auto const bufferLength = buf_len && !(buf_len % 512) ? buf_len : configuration.bufferLength;
+
+    record([&](fake_rtlsdr::statistics & statistics){
+      statistics.bufferCount = bufferCount;
+      statistics.bufferLength = bufferLength;
+    });
+
+    auto buffers = std::vector<std::vector<unsigned char>>(bufferCount, std::vector<unsigned char>(bufferLength));
+
+    // A ramp repeats every 256 bytes, so if the buffers are a multiple of that, they never change
+    auto const isStatic = !has_recording() && !(bufferLength % 256);
+    if(isStatic)
+      {
+      fill(dev, buffers.front().data(), bufferLength);
+      std::fill(buffers.begin() + 1, buffers.end(), buffers.front());
+      }
+    dab::pacer pacer{dev->sampleRate ? dev->sampleRate : dab::kDefaultSampleRate};
+    pacer.speed(configuration.speed);
+
+    auto result = 0;
+    for(std::uint64_t delivered = 0; dev->status.load(std::memory_order_acquire) == async_status::running; ++delivered)
+      {
+      if(configuration.failAfter && delivered == configuration.failAfter)
+        {
+        result = fake_rtlsdr::kDeviceLost;
+        break;
+        }
+
+      if(configuration.stallEvery && delivered && !(delivered % configuration.stallEvery))
+        {
+        std::this_thread::sleep_for(configuration.stallDuration);
+        record([](fake_rtlsdr::statistics & statistics){ ++statistics.stalls; });
+        }
+
+      auto & buffer = buffers[delivered % bufferCount];
+      if(!isStatic)
+        {
+        fill(dev, buffer.data(), buffer.size());
+        }
+
+      pacer.release(bufferLength / 2);
+      cb(buffer.data(), bufferLength, ctx);
+
+      record([&](fake_rtlsdr::statistics & statistics){
+        ++statistics.buffers;
+        statistics.bytes += bufferLength;
+      });
+      }
+
+    dev->status.store(async_status::inactive, std::memory_order_release);
+    return result;
+    }
+
+  int rtlsdr_cancel_async(rtlsdr_dev_t * dev)
+    {
+    if(!dev)
+      {
+      return -1;
+      }
+
+    auto expected = async_status::running;
+    if(!dev->status.compare_exchange_strong(expected, async_status::canceling))
+      {
+      return -2;
+      }
+
+    record([](fake_rtlsdr::statistics & statistics){ ++statistics.cancellations; });
+    return 0;
+    }
+
+  int rtlsdr_set_bias_tee(rtlsdr_dev_t * dev, int)
+    {
+    return dev ? 0 : -1;
+    }
+
+  }
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_FAKE_RTLSDR__FAKE_RTLSDR
+#define DABDEVICE_TEST_FAKE_RTLSDR__FAKE_RTLSDR
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fake_rtlsdr
+  {
+
+  /**
+   * @brief The result of rtlsdr_read_async when the simulated device disappears
+   *
+   * This is the value of LIBUSB_ERROR_NO_DEVICE, which is what librtlsdr reports when a stick is unplugged.
+   */
+  int constexpr kDeviceLost = -4;
+
+  /**
+   * @brief The behavior of the simulated devices
+   *
+   * The defaults describe a single R820T stick that delivers samples as fast as they are consumed.
+   */
+  struct configuration
+    {
+    /**
+     * @brief The number of devices reported by rtlsdr_get_device_count
+     */
+    std::uint32_t nofDevices{1};
+
+    std::string manufacturer{"Realtek"};
+    std::string product{"RTL2838UHIDIR"};
+    std::string serial{"00000001"};
+
+    /**
+     * @brief The supported tuner gains in tenths of a dB
+     */
+    std::vector<int> gains{
+      0, 9, 14, 27, 37, 77, 87, 125, 144, 157, 166, 197, 207, 229, 254,
+      280, 297, 328, 338, 364, 372, 386, 402, 421, 434, 439, 445, 480, 496,
+    };
+
+    /**
+     * @brief The number of USB transfers used when rtlsdr_read_async is passed 0
+     */
+    std::uint32_t bufferCount{15};
+
+    /**
+     * @brief The size of a USB transfer used when rtlsdr_read_async is passed 0 or a size librtlsdr rejects
+     */
+    std::uint32_t bufferLength{16 * 32 * 512};
+
+    /**
+     * @brief The rate at which buffers are delivered, as a multiple of the configured sample rate
+     *
+     * A speed of 0 delivers buffers as fast as the callback returns.
+     */
+    double speed{};
+
+    /**
+     * @brief A recording of raw samples that is delivered in a loop
+     *
+     * If no recording is given, a ramp is delivered: the n-th byte since rtlsdr_read_async was called has the
+     * value n modulo 256. This makes lost or reordered bytes easy to detect.
+     */
+    std::string recording{};
+
+    /**
+     * @brief The center frequencies in Hz on which a signal is on the air
+     *
+     * If the list is empty, the ramp or recording is delivered regardless of the tuned frequency. Otherwise, it
+     * is only delivered while the device is tuned to one of the listed frequencies, and faint noise of +/-1 LSB
+     * around the zero point is delivered everywhere else.
+     */
+    std::vector<std::uint32_t> carriers{};
+
+    /**
+     * @brief The time rtlsdr_open takes to bring up a device
+     */
+    std::chrono::microseconds openDelay{};
+
+    /**
+     * @brief The time rtlsdr_set_center_freq takes to retune the tuner
+     */
+    std::chrono::microseconds tuningDelay{};
+
+    /**
+     * @brief Stall the USB transfers after every n-th buffer, or never if 0
+     */
+    std::uint64_t stallEvery{};
+
+    /**
+     * @brief The duration of a simulated USB stall
+     */
+    std::chrono::microseconds stallDuration{};
+
+    /**
+     * @brief Simulate unplugging the device after n buffers, or never if 0
+     *
+     * rtlsdr_read_async then returns #kDeviceLost.
+     */
+    std::uint64_t failAfter{};
+    };
+
+  /**
+   * @brief What the simulated devices have been asked to do since the last call to #configure
+   */
+  struct statistics
+    {
+    std::uint64_t opened;
+    std::uint64_t closed;
+    std::uint64_t tunes;
+    std::uint64_t buffers;
+    std::uint64_t bytes;
+    std::uint64_t stalls;
+    std::uint64_t cancellations;
+    std::uint32_t bufferCount;
+    std::uint32_t bufferLength;
+    };
+
+  /**
+   * @brief Replace the behavior of the simulated devices and reset the statistics
+   *
+   * The configuration is applied to devices opened and acquisition loops started afterwards.
+   *
+   * @throws std::ios::failure if the recording can not be read
+   */
+  void configure(configuration const & configuration);
+
+  /**
+   * @brief Get the statistics collected since the last call to #configure
+   */
+  statistics stats();
+
+  }
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_FAKE_RTLSDR__RTL_SDR
+#define DABDEVICE_TEST_FAKE_RTLSDR__RTL_SDR
+
+/*
+ * A drop-in replacement for the public header of librtlsdr.
+ *
+ * The declarations mirror those of librtlsdr 0.5.x/0.6.x, so that code written against the real library
+ * compiles unchanged against the loopback implementation in fake_rtlsdr.cpp. See fake_rtlsdr.h for the
+ * functions controlling the behavior of the simulated devices.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rtlsdr_dev rtlsdr_dev_t;
+
+uint32_t rtlsdr_get_device_count(void);
+const char * rtlsdr_get_device_name(uint32_t index);
+int rtlsdr_get_device_usb_strings(uint32_t index, char * manufact, char * product, char * serial);
+int rtlsdr_get_index_by_serial(const char * serial);
+
+int rtlsdr_open(rtlsdr_dev_t * * dev, uint32_t index);
+int rtlsdr_close(rtlsdr_dev_t * dev);
+
+int rtlsdr_set_xtal_freq(rtlsdr_dev_t * dev, uint32_t rtl_freq, uint32_t tuner_freq);
+int rtlsdr_get_xtal_freq(rtlsdr_dev_t * dev, uint32_t * rtl_freq, uint32_t * tuner_freq);
+int rtlsdr_get_usb_strings(rtlsdr_dev_t * dev, char * manufact, char * product, char * serial);
+
+int rtlsdr_set_center_freq(rtlsdr_dev_t * dev, uint32_t freq);
+uint32_t rtlsdr_get_center_freq(rtlsdr_dev_t * dev);
+int rtlsdr_set_freq_correction(rtlsdr_dev_t * dev, int ppm);
+int rtlsdr_get_freq_correction(rtlsdr_dev_t * dev);
+
+enum rtlsdr_tuner
+  {
+  RTLSDR_TUNER_UNKNOWN = 0,
+  RTLSDR_TUNER_E4000,
+  RTLSDR_TUNER_FC0012,
+  RTLSDR_TUNER_FC0013,
+  RTLSDR_TUNER_FC2580,
+  RTLSDR_TUNER_R820T,
+  RTLSDR_TUNER_R828D
+  };
+
+enum rtlsdr_tuner rtlsdr_get_tuner_type(rtlsdr_dev_t * dev);
+int rtlsdr_get_tuner_gains(rtlsdr_dev_t * dev, int * gains);
+int rtlsdr_set_tuner_gain(rtlsdr_dev_t * dev, int gain);
+int rtlsdr_set_tuner_bandwidth(rtlsdr_dev_t * dev, uint32_t bw);
+int rtlsdr_get_tuner_gain(rtlsdr_dev_t * dev);
+int rtlsdr_set_tuner_if_gain(rtlsdr_dev_t * dev, int stage, int gain);
+int rtlsdr_set_tuner_gain_mode(rtlsdr_dev_t * dev, int manual);
+
+int rtlsdr_set_sample_rate(rtlsdr_dev_t * dev, uint32_t rate);
+uint32_t rtlsdr_get_sample_rate(rtlsdr_dev_t * dev);
+int rtlsdr_set_testmode(rtlsdr_dev_t * dev, int on);
+int rtlsdr_set_agc_mode(rtlsdr_dev_t * dev, int on);
+int rtlsdr_set_direct_sampling(rtlsdr_dev_t * dev, int on);
+int rtlsdr_get_direct_sampling(rtlsdr_dev_t * dev);
+int rtlsdr_set_offset_tuning(rtlsdr_dev_t * dev, int on);
+int rtlsdr_get_offset_tuning(rtlsdr_dev_t * dev);
+
+int rtlsdr_reset_buffer(rtlsdr_dev_t * dev);
+int rtlsdr_read_sync(rtlsdr_dev_t * dev, void * buf, int len, int * n_read);
+
+typedef void (* rtlsdr_read_async_cb_t)(unsigned char * buf, uint32_t len, void * ctx);
+
+int rtlsdr_wait_async(rtlsdr_dev_t * dev, rtlsdr_read_async_cb_t cb, void * ctx);
+int rtlsdr_read_async(rtlsdr_dev_t * dev, rtlsdr_read_async_cb_t cb, void * ctx, uint32_t buf_num, uint32_t buf_len);
+int rtlsdr_cancel_async(rtlsdr_dev_t * dev);
+
+int rtlsdr_set_bias_tee(rtlsdr_dev_t * dev, int on);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_PERF_SOAK__CONSTANTS
+#define DABDEVICE_TEST_PERF_SOAK__CONSTANTS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace perf
+      {
+
+      namespace soak
+        {
+
+        auto constexpr kRecordingFileName = "perf_soak_recording";
+
+        auto constexpr kBlockSize = std::size_t{256 * 1024};
+        auto constexpr kPoolBlocks = std::size_t{16};
+
+        /**
+         * @brief The settings of the soak tests, taken from the environment
+         *
+         * The defaults are used for every variable that is not set. CMake passes the values of the
+         * corresponding DABDEVICE_PERF_* cache variables when the tests are run via CTest.
+         */
+        struct settings
+          {
+          static double number(char const * const name, double const fallback)
+            {
+            auto const value = std::getenv(name);
+            return value && *value ? std::atof(value) : fallback;
+            }
+
+          /**
+           * @brief The duration of a single replay
+           */
+          static std::chrono::seconds duration()
+            {
+            return std::chrono::seconds{static_cast<long>(number("DABDEVICE_PERF_SECONDS", 60))};
+            }
+
+          /**
+           * @brief The size of the generated recording in bytes
+           */
+          static std::size_t recording_size()
+            {
+            return static_cast<std::size_t>(number("DABDEVICE_PERF_RECORDING_MIB", 256)) * 1024 * 1024;
+            }
+
+          /**
+           * @brief The lowest acceptable sustained rate in millions of samples per second
+           */
+          static double minimum_msps()
+            {
+            return number("DABDEVICE_PERF_MIN_MSPS", 8.192);
+            }
+
+          /**
+           * @brief The largest acceptable growth of the resident set during a replay in bytes
+           */
+          static double maximum_rss_growth()
+            {
+            return number("DABDEVICE_PERF_MAX_RSS_GROWTH_MIB", 16) * 1024 * 1024;
+            }
+
+          /**
+           * @brief The fraction by which the rate may fall below the recorded baseline
+           */
+          static double tolerance()
+            {
+            return number("DABDEVICE_PERF_TOLERANCE", 0.2);
+            }
+
+          /**
+           * @brief The file holding the baseline rate, which is created by the first run
+           */
+          static std::string baseline()
+            {
+            auto const value = std::getenv("DABDEVICE_PERF_BASELINE");
+            return value && *value ? value : "perf_baseline";
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_PERF_SOAK__REPLAY
+#define DABDEVICE_TEST_PERF_SOAK__REPLAY
+
+#include "constants.h"
+
+#include <dab/device/device_stats.h>
+#include <dab/device/rtl_file.h>
+#include <dab/transport/block_pool.h>
+#include <dab/transport/sink.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace perf
+      {
+
+      namespace soak
+        {
+
+        /**
+         * @brief The observations made during a replay
+         */
+        struct replay_result
+          {
+          std::uint64_t samples;
+          double seconds;
+          std::uint64_t discontinuities;
+          double rssGrowth;
+          dab::device_stats stats;
+
+          double msps() const
+            {
+            return samples / seconds / 1e6;
+            }
+          };
+
+        /**
+         * @brief Get the current resident set size of the process in bytes, or 0 if it is unknown
+         */
+        inline double resident_set()
+          {
+          std::ifstream statm{"/proc/self/statm"};
+          auto pages = 0.0;
+          auto resident = 0.0;
+          if(!(statm >> pages >> resident))
+            {
+            return 0.0;
+            }
+          return resident * sysconf(_SC_PAGESIZE);
+          }
+
+        /**
+         * @brief Replay the looped recording into a block pool for the configured duration
+         *
+         * The device blocks when the pool is full, so every sample of the recording has to arrive. Every received
+         * block is passed to @p inspect. The resident set is compared between the end of the first tenth of the
+         * replay, when all buffers have been allocated, and the end of the replay.
+         */
+        template<typename SampleType, typename Inspect>
+        replay_result replay(Inspect inspect)
+          {
+          using clock = std::chrono::steady_clock;
+
+          dab::basic_block_pool<SampleType> pool{kPoolBlocks, kBlockSize / 2};
+          dab::rtl_file device{pool, kRecordingFileName, kBlockSize};
+          device.enable(dab::device::option::loop);
+          device.overflow(dab::overflow_policy::block);
+
+          auto const duration = settings::duration();
+          auto result = replay_result{};
+          auto warmRss = 0.0;
+          auto warm = false;
+
+          auto const start = clock::now();
+          auto producer = std::thread{[&]{ device.run(); }};
+
+          auto block = typename dab::basic_block_pool<SampleType>::block{};
+          while(clock::now() - start < duration || !result.samples)
+            {
+            if(!pool.receive_for(block, std::chrono::milliseconds{100}))
+              {
+              continue;
+              }
+
+            result.samples += block.size();
+            result.discontinuities += block.discontinuity();
+            inspect(block);
+            block.release();
+
+            if(!warm && clock::now() - start >= duration / 10)
+              {
+              warm = true;
+              warmRss = resident_set();
+              }
+            }
+
+          result.seconds = std::chrono::duration<double>(clock::now() - start).count();
+          result.rssGrowth = warm ? resident_set() - warmRss : 0.0;
+
+          // Stopping aborts the block the device is waiting to deliver, which is then counted as dropped
+          result.stats = device.stats();
+          device.stop();
+          producer.join();
+          return result;
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
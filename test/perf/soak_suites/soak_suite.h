@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_PERF_SOAK__SOAK_SUITE
+#define DABDEVICE_TEST_PERF_SOAK__SOAK_SUITE
+
+#include "constants.h"
+#include "replay.h"
+
+#include <dab/transport/block_pool.h>
+#include <dab/types/raw_sample.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace perf
+      {
+
+      namespace soak
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(soak_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_looped_replay_loses_no_samples),
+              LOCAL_TEST(test_looped_replay_keeps_memory_bounded),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_looped_replay_loses_no_samples()
+            {
+            // The recording is a byte ramp, so every sample continues the ramp of the previous one
+            auto expected = std::uint8_t{};
+            auto mismatches = std::uint64_t{};
+
+            auto const result = replay<dab::raw_sample>([&](dab::raw_block_pool::block const & block){
+              for(auto const & sample : block)
+                {
+                mismatches += sample.inphase != expected || sample.quadrature != std::uint8_t(expected + 1);
+                expected += 2;
+                }
+            });
+
+            ASSERT_EQUAL(0u, mismatches);
+            ASSERT_EQUAL(0u, result.discontinuities);
+            ASSERT_EQUAL(0u, result.stats.droppedSamples);
+            ASSERT(result.samples > settings::recording_size() / 2);
+            }
+
+          void test_looped_replay_keeps_memory_bounded()
+            {
+            auto const result = replay<dab::internal::sample_t>([](dab::sample_block_pool::block const &){});
+
+            ASSERT_LESS_EQUAL(result.rssGrowth, settings::maximum_rss_growth());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
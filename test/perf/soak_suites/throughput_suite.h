@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_PERF_SOAK__THROUGHPUT_SUITE
+#define DABDEVICE_TEST_PERF_SOAK__THROUGHPUT_SUITE
+
+#include "constants.h"
+#include "replay.h"
+
+#include <dab/transport/block_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <dab/types/common_types.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace perf
+      {
+
+      namespace soak
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(throughput_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_replay_sustains_minimum_rate),
+              LOCAL_TEST(test_replay_rate_does_not_regress),
+#undef LOCAL_TEST
+            };
+            }
+
+          static double converted_msps()
+            {
+            auto checksum = 0.0f;
+            auto const result = replay<dab::internal::sample_t>([&](dab::sample_block_pool::block const & block){
+              checksum += block[block.size() - 1].real();
+            });
+
+            std::clog << "sustained " << result.msps() << " Msps (checksum " << checksum << ")\n";
+            return result.msps();
+            }
+
+          void test_replay_sustains_minimum_rate()
+            {
+            ASSERT_GREATER_EQUAL(converted_msps(), settings::minimum_msps());
+            }
+
+          void test_replay_rate_does_not_regress()
+            {
+            auto const msps = converted_msps();
+
+            auto baseline = 0.0;
+            std::ifstream recorded{settings::baseline()};
+            if(!(recorded >> baseline))
+              {
+              std::ofstream{settings::baseline(), std::ios::trunc} << msps << '\n';
+              return;
+              }
+
+            auto message = std::ostringstream{};
+            message << msps << " Msps is more than " << settings::tolerance() * 100 << " % below the baseline of "
+                    << baseline << " Msps recorded in " << settings::baseline();
+            ASSERTM(message.str(), msps >= baseline * (1 - settings::tolerance()));
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__ACQUISITION_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__ACQUISITION_SUITE
+
+#include "collecting_sink.h"
+#include "constants.h"
+
+#include <dab/device/rtl_device.h>
+#include <dab/transport/block_pool.h>
+#include <dab/transport/raw_recorder.h>
+#include <dab/types/common_types.h>
+#include <dab/types/raw_sample.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(acquisition_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_bytes_are_delivered_in_order),
+              LOCAL_TEST(test_samples_are_converted),
+              LOCAL_TEST(test_recording_is_replayed),
+              LOCAL_TEST(test_stalls_do_not_lose_samples),
+              LOCAL_TEST(test_full_sink_does_not_block_acquisition),
+              LOCAL_TEST(test_default_transfers_are_requested),
+              LOCAL_TEST(test_stats_count_every_transfer),
+              LOCAL_TEST(test_drop_oldest_keeps_latest_transfers),
+              LOCAL_TEST(test_librtlsdr_chooses_default_transfers),
+              LOCAL_TEST(test_transfers_are_passed_to_librtlsdr),
+              LOCAL_TEST(test_misaligned_transfer_length_is_rejected),
+              LOCAL_TEST(test_transfer_presets_report_their_latency),
+              LOCAL_TEST(test_replaced_recorder_is_released_by_record),
+#undef LOCAL_TEST
+            };
+            }
+
+          static fake_rtlsdr::configuration configuration()
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            return configuration;
+            }
+
+          static bool is_ramp(std::vector<dab::raw_sample> const & samples)
+            {
+            for(std::size_t index = 0; index < samples.size(); ++index)
+              {
+              if(samples[index].inphase != std::uint8_t(2 * index) || samples[index].quadrature != std::uint8_t(2 * index + 1))
+                {
+                return false;
+                }
+              }
+            return true;
+            }
+
+          void test_bytes_are_delivered_in_order()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{8 * kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT(is_ramp(sink.samples()));
+            }
+
+          void test_samples_are_converted()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::internal::sample_t> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT_EQUAL((dab::internal::sample_t{-1.0f, -127.0f / 128.0f}), sink.samples()[0]);
+            ASSERT_EQUAL((dab::internal::sample_t{126.0f / 128.0f, 127.0f / 128.0f}), sink.samples()[127]);
+            }
+
+          void test_recording_is_replayed()
+            {
+            auto replay = configuration();
+            replay.recording = kRecordingFileName;
+            fake_rtlsdr::configure(replay);
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            for(std::size_t index = 0; index < kBufferSamples; index += 2)
+              {
+              ASSERT_EQUAL(kRecordingData[0], sink.samples()[index].inphase);
+              ASSERT_EQUAL(kRecordingData[1], sink.samples()[index].quadrature);
+              ASSERT_EQUAL(kRecordingData[2], sink.samples()[index + 1].inphase);
+              ASSERT_EQUAL(kRecordingData[3], sink.samples()[index + 1].quadrature);
+              }
+            }
+
+          void test_stalls_do_not_lose_samples()
+            {
+            auto stalling = configuration();
+            stalling.stallEvery = 2;
+            stalling.stallDuration = std::chrono::milliseconds{1};
+            fake_rtlsdr::configure(stalling);
+
+            collecting_sink<dab::raw_sample> sink{6 * kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT(fake_rtlsdr::stats().stalls >= 2);
+            ASSERT(is_ramp(sink.samples()));
+            }
+
+          void test_full_sink_does_not_block_acquisition()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, kBufferSamples};
+            dab::rtl_device device{pool};
+            auto watchdog = std::thread{[&]{
+              while(fake_rtlsdr::stats().buffers < 16)
+                {
+                std::this_thread::yield();
+                }
+              device.stop();
+            }};
+
+            device.run();
+            watchdog.join();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(kBufferSamples, block.size());
+            }
+
+          void test_default_transfers_are_requested()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT_EQUAL(15u, fake_rtlsdr::stats().bufferCount);
+            ASSERT_EQUAL(kBufferLength, fake_rtlsdr::stats().bufferLength);
+            }
+
+          void test_stats_count_every_transfer()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{4 * kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            auto const stats = device.stats();
+            ASSERT_EQUAL(fake_rtlsdr::stats().buffers, stats.callbacks);
+            ASSERT_EQUAL(4 * kBufferSamples, stats.samples);
+            ASSERT_EQUAL(stats.callbacks - 4, stats.droppedBlocks);
+            ASSERT(stats.minCallback <= stats.maxCallback);
+            }
+
+          void test_drop_oldest_keeps_latest_transfers()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{2, kBufferSamples};
+            dab::rtl_device device{pool};
+            device.overflow(dab::overflow_policy::drop_oldest);
+            auto watchdog = std::thread{[&]{
+              while(fake_rtlsdr::stats().buffers < 8)
+                {
+                std::this_thread::yield();
+                }
+              device.stop();
+            }};
+
+            device.run();
+            watchdog.join();
+
+            auto const transfers = fake_rtlsdr::stats().buffers;
+            auto const oldest = pool.receive();
+            ASSERT_EQUAL((transfers - 2) * kBufferSamples, oldest.discontinuity());
+            ASSERT_EQUAL((transfers - 2) * kBufferSamples, device.stats().droppedSamples);
+            ASSERT_EQUAL(0u, pool.receive().discontinuity());
+            }
+
+          void test_librtlsdr_chooses_default_transfers()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT_EQUAL(fake_rtlsdr::configuration{}.bufferCount, fake_rtlsdr::stats().bufferCount);
+            ASSERT_EQUAL(kBufferLength, fake_rtlsdr::stats().bufferLength);
+            }
+
+          void test_transfers_are_passed_to_librtlsdr()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{4 * kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.transfers({4, kBufferLength / 2});
+            device.run();
+
+            ASSERT_EQUAL(4u, fake_rtlsdr::stats().bufferCount);
+            ASSERT_EQUAL(kBufferLength / 2, fake_rtlsdr::stats().bufferLength);
+            ASSERT_EQUAL(4 * kBufferSamples, device.stats().samples);
+            ASSERT_EQUAL(device.stats().callbacks - 8, device.stats().droppedBlocks);
+            }
+
+          void test_misaligned_transfer_length_is_rejected()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            ASSERT_THROWS(device.transfers({4, 1000}), std::invalid_argument);
+            ASSERT_EQUAL(0u, device.transfers().count);
+            }
+
+          void test_transfer_presets_report_their_latency()
+            {
+            auto const lowLatency = dab::rtl_transfers::low_latency();
+            auto const balanced = dab::rtl_transfers::balanced();
+
+            ASSERT_EQUAL(4000, lowLatency.period().count());
+            ASSERT_EQUAL(16000, lowLatency.capacity().count());
+            ASSERT_EQUAL(64000, balanced.period().count());
+            ASSERT_EQUAL(960000, balanced.capacity().count());
+            }
+
+          void test_replaced_recorder_is_released_by_record()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{4, kBufferSamples};
+            dab::rtl_device device{pool};
+            auto recorder = std::make_shared<dab::raw_recorder>(dab::recording_options{kRecorderPrefix});
+            device.record(recorder);
+
+            auto acquisition = std::async(std::launch::async, [&]{ device.run(); });
+            while(fake_rtlsdr::stats().buffers < 8)
+              {
+              std::this_thread::yield();
+              }
+
+            device.record(nullptr);
+            ASSERT_EQUAL(1, recorder.use_count());
+
+            device.stop();
+            acquisition.get();
+            recorder.reset();
+            std::remove((std::string{kRecorderPrefix} + "-000000.raw").c_str());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
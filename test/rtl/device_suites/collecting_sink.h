@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__COLLECTING_SINK
+#define DABDEVICE_TEST_RTL_DEVICE__COLLECTING_SINK
+
+#include <dab/device/device.h>
+#include <dab/transport/sink.h>
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        /**
+         * @brief A sink that collects a fixed number of samples and then stops the device feeding it
+         */
+        template<typename SampleType>
+        struct collecting_sink : dab::basic_sink<SampleType>
+          {
+          explicit collecting_sink(std::size_t const limit) :
+            m_samples(limit)
+            {
+
+            }
+
+          SampleType * reserve(std::size_t & count) override
+            {
+            if(m_collected == m_samples.size())
+              {
+              return nullptr;
+              }
+
+            count = std::min(count, m_samples.size() - m_collected);
+            return m_samples.data() + m_collected;
+            }
+
+          void commit(std::size_t count) override
+            {
+            if(!m_collected)
+              {
+              auto name = std::array<char, 16>{};
+              pthread_getname_np(pthread_self(), name.data(), name.size());
+              m_producer = name.data();
+              }
+
+            m_collected += count;
+            if(m_collected == m_samples.size() && m_device)
+              {
+              m_device->stop();
+              }
+            }
+
+          void retuned(dab::frequency const centerFrequency) override
+            {
+            m_retunes.push_back({m_collected, static_cast<std::uint32_t>(centerFrequency)});
+            }
+
+          void stop(dab::device & device)
+            {
+            m_device = &device;
+            }
+
+          void rewind()
+            {
+            m_collected = 0;
+            }
+
+          std::vector<SampleType> const & samples() const
+            {
+            return m_samples;
+            }
+
+          /**
+           * @brief The number of samples collected before each retune, together with the new center frequency
+           */
+          std::vector<std::pair<std::size_t, std::uint32_t>> const & retunes() const
+            {
+            return m_retunes;
+            }
+
+          /**
+           * @brief The name of the thread that committed the first samples
+           */
+          std::string const & producer() const
+            {
+            return m_producer;
+            }
+
+          private:
+            std::vector<SampleType> m_samples;
+            std::size_t m_collected{};
+            dab::device * m_device{};
+            std::string m_producer{};
+            std::vector<std::pair<std::size_t, std::uint32_t>> m_retunes{};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__CONSTANTS
+#define DABDEVICE_TEST_RTL_DEVICE__CONSTANTS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        /**
+         * @brief The size of the simulated USB transfers
+         *
+         * Smaller than the librtlsdr default, so that a test sees many callbacks without moving much data.
+         */
+        auto constexpr kBufferLength = std::uint32_t{16 * 512};
+
+        /**
+         * @brief The number of samples in a simulated USB transfer
+         */
+        auto constexpr kBufferSamples = std::size_t{kBufferLength / 2};
+
+        auto constexpr kRecordingFileName = "rtl_device_recording.raw";
+
+        auto constexpr kOccupancyFileName = "rtl_device_occupancy.txt";
+
+        auto constexpr kRecorderPrefix = "rtl_device_recorder";
+
+        /**
+         * @brief The contents of #kRecordingFileName
+         */
+        unsigned char const kRecordingData[] = {0, 255, 128, 64};
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
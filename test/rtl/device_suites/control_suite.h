@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__CONTROL_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__CONTROL_SUITE
+
+#include "collecting_sink.h"
+#include "constants.h"
+
+#include <dab/device/rtl_device.h>
+#include <dab/types/gain.h>
+#include <dab/types/raw_sample.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(control_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_gains_are_reported_in_db),
+              LOCAL_TEST(test_initial_gain_is_median_gain),
+              LOCAL_TEST(test_gain_selects_closest_supported_gain),
+              LOCAL_TEST(test_tune_reaches_frequency),
+              LOCAL_TEST(test_tune_waits_for_tuner),
+              LOCAL_TEST(test_automatic_gain_control_can_be_toggled),
+#undef LOCAL_TEST
+            };
+            }
+
+          static fake_rtlsdr::configuration configuration()
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            configuration.gains = {0, 90, 140, 270, 370};
+            return configuration;
+            }
+
+          void test_gains_are_reported_in_db()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            auto const gains = device.gains();
+            ASSERT_EQUAL(5u, gains.size());
+            ASSERT_EQUAL(0.0f, gains[0].value());
+            ASSERT_EQUAL(37.0f, gains[4].value());
+            }
+
+          void test_initial_gain_is_median_gain()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            ASSERT_EQUAL(14.0f, device.gain().value());
+            }
+
+          void test_gain_selects_closest_supported_gain()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            ASSERT(device.gain(dab::gain{30.0f}));
+            ASSERT_EQUAL(27.0f, device.gain().value());
+            }
+
+          void test_tune_reaches_frequency()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            ASSERT(device.tune(dab::frequency{229072000}));
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().tunes);
+            }
+
+          void test_tune_waits_for_tuner()
+            {
+            auto slowTuner = configuration();
+            slowTuner.tuningDelay = std::chrono::milliseconds{20};
+            fake_rtlsdr::configure(slowTuner);
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            auto const start = std::chrono::steady_clock::now();
+            device.tune(dab::frequency{229072000});
+            ASSERT(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{20});
+            }
+
+          void test_automatic_gain_control_can_be_toggled()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+
+            ASSERT(device.enable(dab::device::option::automatic_gain_control));
+            ASSERT(device.disable(dab::device::option::automatic_gain_control));
+            ASSERT(!device.enable(dab::device::option::loop));
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__GROUP_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__GROUP_SUITE
+
+#include "constants.h"
+
+#include <dab/device/device_group.h>
+#include <dab/device/rtl_device.h>
+#include <dab/transport/block_pool.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(group_tests)
+          {
+          using group_type = dab::device_group<dab::rtl_device, dab::raw_block_pool>;
+
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_group_opens_every_device),
+              LOCAL_TEST(test_devices_are_opened_in_parallel),
+              LOCAL_TEST(test_failed_open_closes_opened_devices),
+              LOCAL_TEST(test_every_device_publishes_into_its_own_transport),
+              LOCAL_TEST(test_stats_are_aggregated),
+              LOCAL_TEST(test_unplugged_device_is_reported_by_stop),
+              LOCAL_TEST(test_group_is_closed_on_destruction),
+              LOCAL_TEST(test_stop_right_after_start_stops_every_device),
+#undef LOCAL_TEST
+            };
+            }
+
+          static fake_rtlsdr::configuration configuration(std::uint32_t const nofDevices)
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            configuration.nofDevices = nofDevices;
+            return configuration;
+            }
+
+          static std::unique_ptr<dab::raw_block_pool> make_pool(dab::device::descriptor const &)
+            {
+            return std::unique_ptr<dab::raw_block_pool>{new dab::raw_block_pool{4, kBufferSamples}};
+            }
+
+          static void wait_for_buffers(std::uint64_t const count)
+            {
+            while(fake_rtlsdr::stats().buffers < count)
+              {
+              std::this_thread::yield();
+              }
+            }
+
+          void test_group_opens_every_device()
+            {
+            fake_rtlsdr::configure(configuration(3));
+
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+
+            ASSERT_EQUAL(3u, group.size());
+            ASSERT_EQUAL(3u, fake_rtlsdr::stats().opened);
+            ASSERT_EQUAL(2u, group.descriptor(2).id);
+            }
+
+          void test_devices_are_opened_in_parallel()
+            {
+            auto slowOpen = configuration(4);
+            slowOpen.openDelay = std::chrono::milliseconds{100};
+            fake_rtlsdr::configure(slowOpen);
+
+            auto const start = std::chrono::steady_clock::now();
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+            auto const duration = std::chrono::steady_clock::now() - start;
+
+            ASSERT_LESS(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), 300);
+            }
+
+          void test_failed_open_closes_opened_devices()
+            {
+            fake_rtlsdr::configure(configuration(2));
+
+            auto descriptors = dab::rtl_device::descriptors();
+            descriptors.push_back({5, "00000005", "RTL2838UHIDIR", "Realtek", typeid(dab::rtl_device)});
+
+            ASSERT_THROWS((group_type{descriptors, make_pool}), std::runtime_error);
+            ASSERT_EQUAL(2u, fake_rtlsdr::stats().opened);
+            ASSERT_EQUAL(2u, fake_rtlsdr::stats().closed);
+            }
+
+          void test_every_device_publishes_into_its_own_transport()
+            {
+            fake_rtlsdr::configure(configuration(2));
+
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+            group.start();
+            wait_for_buffers(16);
+            group.stop();
+
+            ASSERT(group.transport(0).buffered());
+            ASSERT(group.transport(1).buffered());
+            ASSERT(!group[0].running());
+            ASSERT(!group[1].running());
+            }
+
+          void test_stats_are_aggregated()
+            {
+            fake_rtlsdr::configure(configuration(2));
+
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+            group.start();
+            wait_for_buffers(16);
+            group.stop();
+
+            auto const first = group.stats(0);
+            auto const second = group.stats(1);
+            auto const total = group.stats();
+            ASSERT_EQUAL(first.callbacks + second.callbacks, total.callbacks);
+            ASSERT_EQUAL(first.samples + second.samples, total.samples);
+            ASSERT_EQUAL(first.droppedSamples + second.droppedSamples, total.droppedSamples);
+            ASSERT_EQUAL(std::max(first.maxCallback, second.maxCallback).count(), total.maxCallback.count());
+            ASSERT_EQUAL(std::min(first.minCallback, second.minCallback).count(), total.minCallback.count());
+            }
+
+          void test_unplugged_device_is_reported_by_stop()
+            {
+            auto unplugging = configuration(2);
+            unplugging.failAfter = 4;
+            fake_rtlsdr::configure(unplugging);
+
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+            group.start();
+            wait_for_buffers(8);
+            while(group[0].running() || group[1].running())
+              {
+              std::this_thread::yield();
+              }
+
+            ASSERT_THROWS(group.stop(), std::runtime_error);
+            }
+
+          void test_group_is_closed_on_destruction()
+            {
+            fake_rtlsdr::configure(configuration(3));
+
+              {
+              group_type group{dab::rtl_device::descriptors(), make_pool};
+              group.start();
+              wait_for_buffers(3);
+              }
+
+            ASSERT_EQUAL(3u, fake_rtlsdr::stats().closed);
+            }
+
+          void test_stop_right_after_start_stops_every_device()
+            {
+            fake_rtlsdr::configure(configuration(2));
+
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+            for(auto round = 0; round < 20; ++round)
+              {
+              group.start();
+              group.stop();
+
+              ASSERT(!group[0].running());
+              ASSERT(!group[1].running());
+              }
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
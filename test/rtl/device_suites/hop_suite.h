@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__HOP_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__HOP_SUITE
+
+#include "collecting_sink.h"
+#include "constants.h"
+
+#include <dab/constants/channels.h>
+#include <dab/device/hop_schedule.h>
+#include <dab/device/rtl_device.h>
+#include <dab/transport/block_pool.h>
+#include <dab/types/raw_sample.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(hop_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_schedule_without_hops_is_rejected),
+              LOCAL_TEST(test_schedule_without_dwell_time_is_rejected),
+              LOCAL_TEST(test_schedule_period_includes_settling),
+              LOCAL_TEST(test_hops_are_visited_in_rotation),
+              LOCAL_TEST(test_samples_belong_to_their_channel),
+              LOCAL_TEST(test_settling_samples_are_discarded),
+              LOCAL_TEST(test_blocks_are_tagged_with_their_channel),
+              LOCAL_TEST(test_single_channel_samples_are_contiguous),
+              LOCAL_TEST(test_retune_is_reported_as_discontinuity),
+              LOCAL_TEST(test_schedule_cannot_change_while_running),
+#undef LOCAL_TEST
+            };
+            }
+
+          static auto constexpr kSamplesPerMillisecond = std::size_t{2048};
+
+          static fake_rtlsdr::configuration configuration()
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            configuration.carriers = {static_cast<std::uint32_t>(dab::kChannels[2].freq)};
+            return configuration;
+            }
+
+          static std::shared_ptr<dab::hop_schedule const> schedule()
+            {
+            return std::make_shared<dab::hop_schedule const>(std::vector<dab::hop>{
+              {dab::kChannels[2], std::chrono::milliseconds{1}},
+              {dab::kChannels[30], std::chrono::milliseconds{2}},
+            }, std::chrono::milliseconds{1});
+            }
+
+          static bool is_quiet(std::vector<dab::raw_sample> const & samples, std::size_t const begin, std::size_t const end)
+            {
+            for(auto index = begin; index < end; ++index)
+              {
+              if(samples[index].inphase < 127 || samples[index].inphase > 129 ||
+                 samples[index].quadrature < 127 || samples[index].quadrature > 129)
+                {
+                return false;
+                }
+              }
+            return true;
+            }
+
+          void test_schedule_without_hops_is_rejected()
+            {
+            ASSERT_THROWS((dab::hop_schedule{std::vector<dab::hop>{}}), std::invalid_argument);
+            }
+
+          void test_schedule_without_dwell_time_is_rejected()
+            {
+            ASSERT_THROWS((dab::hop_schedule{{{dab::kChannels[0], std::chrono::milliseconds{0}}}}), std::invalid_argument);
+            }
+
+          void test_schedule_period_includes_settling()
+            {
+            ASSERT_EQUAL(5, schedule()->period().count());
+            ASSERT_EQUAL(2 * kSamplesPerMillisecond, schedule()->dwell_samples(1));
+            ASSERT_EQUAL(kSamplesPerMillisecond, schedule()->settle_samples());
+            ASSERT_EQUAL(1u, schedule()->index_of(dab::kChannels[30].freq));
+            ASSERT_EQUAL(2u, schedule()->index_of(dab::kChannels[0].freq));
+            }
+
+          void test_hops_are_visited_in_rotation()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{6 * kSamplesPerMillisecond};
+            dab::rtl_device device{sink};
+            device.hopping(schedule());
+            sink.stop(device);
+            device.run();
+
+            auto const first = static_cast<std::uint32_t>(dab::kChannels[2].freq);
+            auto const second = static_cast<std::uint32_t>(dab::kChannels[30].freq);
+            auto const expected = std::vector<std::pair<std::size_t, std::uint32_t>>{
+              {0, first},
+              {kSamplesPerMillisecond, second},
+              {3 * kSamplesPerMillisecond, first},
+              {4 * kSamplesPerMillisecond, second},
+            };
+
+            ASSERT(expected == sink.retunes());
+            ASSERT_EQUAL(4u, fake_rtlsdr::stats().tunes);
+            }
+
+          void test_samples_belong_to_their_channel()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{3 * kSamplesPerMillisecond};
+            dab::rtl_device device{sink};
+            device.hopping(schedule());
+            sink.stop(device);
+            device.run();
+
+            ASSERT(!is_quiet(sink.samples(), 0, kSamplesPerMillisecond));
+            ASSERT(is_quiet(sink.samples(), kSamplesPerMillisecond, 3 * kSamplesPerMillisecond));
+            }
+
+          void test_settling_samples_are_discarded()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{3 * kSamplesPerMillisecond};
+            dab::rtl_device device{sink};
+            device.hopping(schedule());
+            sink.stop(device);
+            device.run();
+
+            ASSERT_EQUAL(2 * 5 * kSamplesPerMillisecond, fake_rtlsdr::stats().bytes);
+            ASSERT_EQUAL(3 * kSamplesPerMillisecond, device.stats().samples);
+            ASSERT_EQUAL(0u, device.stats().droppedSamples);
+            }
+
+          void test_blocks_are_tagged_with_their_channel()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{16, kSamplesPerMillisecond / 2};
+            dab::rtl_device device{pool};
+            device.hopping(schedule());
+            device.overflow(dab::overflow_policy::block);
+            auto running = std::async(std::launch::async, [&]{ device.run(); });
+
+            auto const hops = schedule();
+            auto tags = std::vector<std::size_t>{};
+            auto retunes = std::vector<bool>{};
+            for(auto index = 0; index < 12; ++index)
+              {
+              auto const block = pool.receive();
+              tags.push_back(hops->index_of(block.center_frequency()));
+              retunes.push_back(block.metadata().has(dab::block_metadata::kRetuned));
+              }
+
+            device.stop();
+            running.get();
+
+            ASSERT((std::vector<std::size_t>{0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}) == tags);
+            ASSERT((std::vector<bool>{1, 0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0}) == retunes);
+            }
+
+          void test_single_channel_samples_are_contiguous()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{4 * kSamplesPerMillisecond};
+            dab::rtl_device device{sink};
+            device.hopping(std::make_shared<dab::hop_schedule const>(std::vector<dab::hop>{
+              {dab::kChannels[2], std::chrono::milliseconds{1}},
+            }, std::chrono::milliseconds{1}));
+            sink.stop(device);
+            device.run();
+
+            auto const & samples = sink.samples();
+            for(auto index = std::size_t{1}; index < samples.size(); ++index)
+              {
+              ASSERT_EQUAL(std::uint8_t(samples[index - 1].inphase + 2), samples[index].inphase);
+              }
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().tunes);
+            ASSERT_EQUAL(2 * 5 * kSamplesPerMillisecond, fake_rtlsdr::stats().bytes);
+            ASSERT_EQUAL(1u, sink.retunes().size());
+            }
+
+          void test_retune_is_reported_as_discontinuity()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{16, kSamplesPerMillisecond};
+            dab::rtl_device device{pool};
+            device.hopping(schedule());
+            device.overflow(dab::overflow_policy::block);
+            auto running = std::async(std::launch::async, [&]{ device.run(); });
+
+            auto blocks = std::vector<dab::block_metadata>{};
+            auto gaps = std::vector<std::size_t>{};
+            for(auto index = 0; index < 4; ++index)
+              {
+              auto const block = pool.receive();
+              blocks.push_back(block.metadata());
+              gaps.push_back(block.discontinuity());
+              }
+
+            device.stop();
+            running.get();
+
+            ASSERT((std::vector<std::size_t>{0, kSamplesPerMillisecond, 0, kSamplesPerMillisecond}) == gaps);
+            ASSERT_EQUAL(0u, blocks[0].sampleIndex);
+            ASSERT_EQUAL(2 * kSamplesPerMillisecond, blocks[1].sampleIndex);
+            ASSERT_EQUAL(3 * kSamplesPerMillisecond, blocks[2].sampleIndex);
+            ASSERT_EQUAL(5 * kSamplesPerMillisecond, blocks[3].sampleIndex);
+            ASSERT(blocks[1].has(dab::block_metadata::kDiscontinuity));
+            ASSERT(!blocks[2].has(dab::block_metadata::kDiscontinuity));
+            }
+
+          void test_schedule_cannot_change_while_running()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+            device.hopping(schedule());
+            auto running = std::async(std::launch::async, [&]{ device.run(); });
+
+            while(!device.running())
+              {
+              std::this_thread::yield();
+              }
+
+            ASSERT_THROWS(device.hopping(nullptr), std::logic_error);
+            device.stop();
+            running.get();
+            ASSERT(device.hopping());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__LIFECYCLE_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__LIFECYCLE_SUITE
+
+#include "collecting_sink.h"
+#include "constants.h"
+
+#include <dab/device/rtl_device.h>
+#include <dab/types/raw_sample.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(lifecycle_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_missing_device_is_reported),
+              LOCAL_TEST(test_invalid_index_is_reported),
+              LOCAL_TEST(test_device_is_closed_on_destruction),
+              LOCAL_TEST(test_descriptors_report_usb_strings),
+              LOCAL_TEST(test_stop_cancels_acquisition),
+              LOCAL_TEST(test_stop_before_first_buffer_ends_run),
+              LOCAL_TEST(test_stop_right_after_start_ends_run),
+              LOCAL_TEST(test_acquisition_can_be_restarted),
+              LOCAL_TEST(test_unplugged_device_is_reported),
+              LOCAL_TEST(test_thread_options_are_applied_to_reader_thread),
+              LOCAL_TEST(test_failed_thread_options_are_reported),
+#undef LOCAL_TEST
+            };
+            }
+
+          static fake_rtlsdr::configuration configuration()
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            return configuration;
+            }
+
+          void test_missing_device_is_reported()
+            {
+            auto noDevices = configuration();
+            noDevices.nofDevices = 0;
+            fake_rtlsdr::configure(noDevices);
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            ASSERT_THROWS(dab::rtl_device{sink}, std::runtime_error);
+            }
+
+          void test_invalid_index_is_reported()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            ASSERT_THROWS((dab::rtl_device{sink, 1}), std::runtime_error);
+            }
+
+          void test_device_is_closed_on_destruction()
+            {
+            fake_rtlsdr::configure(configuration());
+
+              {
+              collecting_sink<dab::raw_sample> sink{kBufferSamples};
+              dab::rtl_device device{sink};
+              ASSERT_EQUAL(0u, fake_rtlsdr::stats().closed);
+              }
+
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().opened);
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().closed);
+            }
+
+          void test_descriptors_report_usb_strings()
+            {
+            auto twoDevices = configuration();
+            twoDevices.nofDevices = 2;
+            twoDevices.serial = "DAB-12C";
+            fake_rtlsdr::configure(twoDevices);
+
+            auto const descriptors = dab::rtl_device::descriptors();
+            ASSERT_EQUAL(2u, descriptors.size());
+            ASSERT_EQUAL(1u, descriptors[1].id);
+            ASSERT_EQUAL("DAB-12C", descriptors[1].serial);
+            ASSERT_EQUAL("RTL2838UHIDIR", descriptors[1].kind);
+            }
+
+          void test_stop_cancels_acquisition()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{4 * kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().cancellations);
+            ASSERT(fake_rtlsdr::stats().buffers >= 4);
+            }
+
+          void test_stop_before_first_buffer_ends_run()
+            {
+            // At a hundredth of the real rate, the first buffer takes 200ms to arrive
+            auto slow = configuration();
+            slow.speed = 0.01;
+            fake_rtlsdr::configure(slow);
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            auto acquisition = std::async(std::launch::async, [&]{ device.run(); });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            device.stop();
+
+            ASSERT(acquisition.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+            acquisition.get();
+            }
+
+          void test_stop_right_after_start_ends_run()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            for(auto round = 1u; round <= 20; ++round)
+              {
+              auto acquisition = std::async(std::launch::async, [&]{ device.run(); });
+              device.wait_for_starts(round);
+              device.stop();
+
+              ASSERT(acquisition.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+              acquisition.get();
+              }
+            }
+
+          void test_acquisition_can_be_restarted()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            device.run();
+
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().cancellations);
+            sink.rewind();
+            device.run();
+            ASSERT_EQUAL(2u, fake_rtlsdr::stats().cancellations);
+            }
+
+          void test_unplugged_device_is_reported()
+            {
+            auto unplugged = configuration();
+            unplugged.failAfter = 3;
+            fake_rtlsdr::configure(unplugged);
+
+            collecting_sink<dab::raw_sample> sink{100 * kBufferSamples};
+            dab::rtl_device device{sink};
+
+            ASSERT_THROWS(device.run(), std::runtime_error);
+            ASSERT_EQUAL(3u, fake_rtlsdr::stats().buffers);
+            }
+
+          void test_thread_options_are_applied_to_reader_thread()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            sink.stop(device);
+            auto options = dab::thread_options{};
+            options.name = "dab-rtl-reader";
+            device.threading(options);
+            device.run();
+
+            ASSERT_EQUAL("dab-rtl-reader", sink.producer());
+            }
+
+          void test_failed_thread_options_are_reported()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            collecting_sink<dab::raw_sample> sink{kBufferSamples};
+            dab::rtl_device device{sink};
+            auto options = dab::thread_options{};
+            options.scheduling = dab::scheduling_policy::round_robin;
+            options.priority = sched_get_priority_max(SCHED_RR) + 1;
+            device.threading(options);
+
+            ASSERT_THROWS(device.run(), std::system_error);
+            ASSERT(!device.running());
+            ASSERT_EQUAL(0u, fake_rtlsdr::stats().buffers);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__READ_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__READ_SUITE
+
+#include "constants.h"
+
+#include <dab/constants/channels.h>
+#include <dab/device/rtl_device.h>
+#include <dab/transport/block_pool.h>
+#include <dab/types/raw_sample.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(read_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_read_delivers_bytes_in_order),
+              LOCAL_TEST(test_read_keeps_samples_beyond_count),
+              LOCAL_TEST(test_read_is_limited_to_one_transfer_per_call),
+              LOCAL_TEST(test_read_is_counted_in_stats),
+              LOCAL_TEST(test_read_while_running_is_rejected),
+              LOCAL_TEST(test_read_after_tune_discards_kept_samples),
+              LOCAL_TEST(test_read_after_gain_change_discards_kept_samples),
+#undef LOCAL_TEST
+            };
+            }
+
+          static fake_rtlsdr::configuration configuration()
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            return configuration;
+            }
+
+          static bool is_ramp(std::vector<dab::raw_sample> const & samples)
+            {
+            for(std::size_t index = 0; index < samples.size(); ++index)
+              {
+              if(samples[index].inphase != std::uint8_t(2 * index) || samples[index].quadrature != std::uint8_t(2 * index + 1))
+                {
+                return false;
+                }
+              }
+            return true;
+            }
+
+          void test_read_delivers_bytes_in_order()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto samples = std::vector<dab::raw_sample>(3 * kBufferSamples);
+            ASSERT_EQUAL(samples.size(), device.read(samples.data(), samples.size()));
+            ASSERT(is_ramp(samples));
+            ASSERT_EQUAL(0u, pool.buffered());
+            }
+
+          void test_read_keeps_samples_beyond_count()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto samples = std::vector<dab::raw_sample>(256);
+            ASSERT_EQUAL(3u, device.read(samples.data(), 3));
+            ASSERT_EQUAL(253u, device.read(samples.data() + 3, 253));
+            ASSERT(is_ramp(samples));
+            ASSERT_EQUAL(1u, fake_rtlsdr::stats().buffers);
+            ASSERT_EQUAL(512u, fake_rtlsdr::stats().bytes);
+            }
+
+          void test_read_is_limited_to_one_transfer_per_call()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto const count = std::size_t{2 * dab::rtl_transfers::balanced().samples()};
+            auto samples = std::vector<dab::raw_sample>(count);
+            ASSERT_EQUAL(count, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(2u, fake_rtlsdr::stats().buffers);
+            }
+
+          void test_read_is_counted_in_stats()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto samples = std::vector<dab::raw_sample>(kBufferSamples);
+            device.read(samples.data(), samples.size());
+
+            ASSERT_EQUAL(kBufferSamples, device.stats().samples);
+            ASSERT_EQUAL(0u, device.stats().droppedSamples);
+            }
+
+          void test_read_while_running_is_rejected()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, kBufferSamples};
+            dab::rtl_device device{pool};
+            auto acquisition = std::async(std::launch::async, [&]{ device.run(); });
+            while(!device.running())
+              {
+              std::this_thread::yield();
+              }
+
+            auto samples = std::vector<dab::raw_sample>(kBufferSamples);
+            ASSERT_THROWS(device.read(samples.data(), samples.size()), std::logic_error);
+
+            device.stop();
+            acquisition.get();
+            }
+
+          void test_read_after_tune_discards_kept_samples()
+            {
+            auto onAir = configuration();
+            onAir.carriers = {static_cast<std::uint32_t>(dab::kChannels[2].freq)};
+            fake_rtlsdr::configure(onAir);
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+            device.tune(dab::kChannels[2].freq);
+
+            auto samples = std::vector<dab::raw_sample>(4);
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+            ASSERT(is_ramp(samples));
+
+            device.tune(dab::kChannels[30].freq);
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+            for(auto const & sample : samples)
+              {
+              ASSERT_LESS(std::abs(sample.inphase - 128), 2);
+              ASSERT_LESS(std::abs(sample.quadrature - 128), 2);
+              }
+            ASSERT_EQUAL(2u, fake_rtlsdr::stats().buffers);
+            }
+
+          void test_read_after_gain_change_discards_kept_samples()
+            {
+            fake_rtlsdr::configure(configuration());
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto samples = std::vector<dab::raw_sample>(4);
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+
+            device.gain(device.gains().front());
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(2u, fake_rtlsdr::stats().buffers);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_DEVICE__SCAN_SUITE
+#define DABDEVICE_TEST_RTL_DEVICE__SCAN_SUITE
+
+#include "constants.h"
+
+#include <dab/device/device_group.h>
+#include <dab/device/rtl_device.h>
+#include <dab/device/scanner.h>
+#include <dab/transport/block_pool.h>
+
+#include <fake_rtlsdr.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace device
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(scan_tests)
+          {
+          using group_type = dab::device_group<dab::rtl_device, dab::raw_block_pool>;
+
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_occupied_channels_are_ranked_first),
+              LOCAL_TEST(test_group_shares_channels_between_devices),
+              LOCAL_TEST(test_occupancy_survives_round_trip),
+              LOCAL_TEST(test_fresh_cache_is_used),
+              LOCAL_TEST(test_stale_cache_is_replaced),
+              LOCAL_TEST(test_cache_of_other_channels_is_replaced),
+#undef LOCAL_TEST
+            };
+            }
+
+          static fake_rtlsdr::configuration configuration(std::uint32_t const nofDevices)
+            {
+            auto configuration = fake_rtlsdr::configuration{};
+            configuration.bufferLength = kBufferLength;
+            configuration.nofDevices = nofDevices;
+            configuration.carriers = {
+              static_cast<std::uint32_t>(dab::kChannels[2].freq),
+              static_cast<std::uint32_t>(dab::kChannels[30].freq),
+            };
+            return configuration;
+            }
+
+          static dab::scan_options options()
+            {
+            auto options = dab::scan_options{};
+            options.settle = std::chrono::milliseconds{0};
+            options.discard = 512;
+            options.samples = 4096;
+            return options;
+            }
+
+          static std::unique_ptr<dab::raw_block_pool> make_pool(dab::device::descriptor const &)
+            {
+            return std::unique_ptr<dab::raw_block_pool>{new dab::raw_block_pool{1, 1}};
+            }
+
+          static std::size_t nof_occupied(dab::occupancy_map const & map)
+            {
+            return std::count_if(map.channels.begin(), map.channels.end(), [](dab::channel_occupancy const & channel){
+              return channel.occupied;
+            });
+            }
+
+          void test_occupied_channels_are_ranked_first()
+            {
+            fake_rtlsdr::configure(configuration(1));
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto const map = dab::scan(device, dab::band_iii_channels(), options());
+
+            ASSERT_EQUAL(dab::kChannels.size(), map.channels.size());
+            ASSERT_EQUAL(2u, nof_occupied(map));
+            ASSERT_EQUAL("5C", map.channels[0].label);
+            ASSERT_EQUAL("12C", map.channels[1].label);
+            ASSERT_LESS(30.0, map.channels[1].margin);
+            ASSERT_EQUAL_DELTA(0.0, map.channels.back().margin, 1.0);
+            }
+
+          void test_group_shares_channels_between_devices()
+            {
+            auto slowSettling = options();
+            slowSettling.settle = std::chrono::milliseconds{20};
+            fake_rtlsdr::configure(configuration(4));
+
+            group_type group{dab::rtl_device::descriptors(), make_pool};
+
+            auto const start = std::chrono::steady_clock::now();
+            auto const map = dab::scan(group, dab::band_iii_channels(), slowSettling);
+            auto const duration = std::chrono::steady_clock::now() - start;
+
+            ASSERT_EQUAL(dab::kChannels.size(), map.channels.size());
+            ASSERT_EQUAL(dab::kChannels.size(), fake_rtlsdr::stats().tunes);
+            ASSERT_EQUAL(2u, nof_occupied(map));
+            ASSERT_EQUAL("5C", map.channels[0].label);
+            ASSERT_LESS(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), 500);
+            }
+
+          void test_occupancy_survives_round_trip()
+            {
+            fake_rtlsdr::configure(configuration(1));
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto const map = dab::scan(device, dab::band_iii_channels(), options());
+            dab::save_occupancy(map, kOccupancyFileName);
+            auto const loaded = dab::load_occupancy(kOccupancyFileName);
+
+            ASSERT_EQUAL(std::chrono::system_clock::to_time_t(map.time), std::chrono::system_clock::to_time_t(loaded.time));
+            ASSERT_EQUAL(map.channels.size(), loaded.channels.size());
+            for(std::size_t index = 0; index < map.channels.size(); ++index)
+              {
+              ASSERT_EQUAL(map.channels[index].label, loaded.channels[index].label);
+              ASSERT_EQUAL(std::uint32_t(map.channels[index].freq), std::uint32_t(loaded.channels[index].freq));
+              ASSERT_EQUAL(map.channels[index].power, loaded.channels[index].power);
+              ASSERT_EQUAL(map.channels[index].margin, loaded.channels[index].margin);
+              ASSERT_EQUAL(map.channels[index].occupied, loaded.channels[index].occupied);
+              }
+            }
+
+          void test_fresh_cache_is_used()
+            {
+            fake_rtlsdr::configure(configuration(1));
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            std::remove(kOccupancyFileName);
+            dab::cached_scan(device, dab::band_iii_channels(), kOccupancyFileName, std::chrono::hours{1}, options());
+            auto const scanned = fake_rtlsdr::stats().tunes;
+            auto const map = dab::cached_scan(device, dab::band_iii_channels(), kOccupancyFileName, std::chrono::hours{1}, options());
+
+            ASSERT_EQUAL(dab::kChannels.size(), scanned);
+            ASSERT_EQUAL(scanned, fake_rtlsdr::stats().tunes);
+            ASSERT_EQUAL("5C", map.channels[0].label);
+            }
+
+          void test_stale_cache_is_replaced()
+            {
+            fake_rtlsdr::configure(configuration(1));
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto stale = dab::scan(device, dab::band_iii_channels(), options());
+            stale.time -= std::chrono::hours{2};
+            dab::save_occupancy(stale, kOccupancyFileName);
+            auto const scanned = fake_rtlsdr::stats().tunes;
+            dab::cached_scan(device, dab::band_iii_channels(), kOccupancyFileName, std::chrono::hours{1}, options());
+
+            ASSERT_EQUAL(2 * scanned, fake_rtlsdr::stats().tunes);
+            ASSERT(dab::load_occupancy(kOccupancyFileName).time > std::chrono::system_clock::now() - std::chrono::minutes{1});
+            }
+
+          void test_cache_of_other_channels_is_replaced()
+            {
+            fake_rtlsdr::configure(configuration(1));
+
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_device device{pool};
+
+            auto const channels = dab::band_iii_channels();
+            auto const subset = std::vector<dab::channel>(channels.begin(), channels.begin() + 3);
+
+            dab::cached_scan(device, channels, kOccupancyFileName, std::chrono::hours{1}, options());
+            auto const scanned = fake_rtlsdr::stats().tunes;
+            auto const map = dab::cached_scan(device, subset, kOccupancyFileName, std::chrono::hours{1}, options());
+
+            ASSERT_EQUAL(scanned + 3, fake_rtlsdr::stats().tunes);
+            ASSERT_EQUAL(3u, map.channels.size());
+            ASSERT_EQUAL("5C", map.channels[0].label);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
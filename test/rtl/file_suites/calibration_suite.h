@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__CALIBRATION_SUITE
+#define DABDEVICE_TEST_RTL_FILE__CALIBRATION_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_file.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(calibration_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_calibration_is_applied),
+              LOCAL_TEST(test_tuning_selects_calibration),
+              LOCAL_TEST(test_empty_source_restores_raw_conversion),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_calibration_is_applied()
+            {
+            dab::rtl_file device{m_queue, kEvenSampleFileName};
+            device.calibrate(dab::conversion::fixed({-1.0f, -0.75f, 2.0f}));
+            device.run();
+
+            ASSERT_EQUAL((dab::internal::sample_t{0.0f, 0.0f}), first());
+            }
+
+          void test_tuning_selects_calibration()
+            {
+            dab::rtl_file device{m_queue, kEvenSampleFileName};
+            device.calibrate([](dab::frequency frequency, dab::gain){
+              return dab::conversion::calibration{std::uint32_t(frequency) ? -1.0f : 0.0f};
+            });
+            device.tune(dab::frequency{227360000});
+            device.run();
+
+            ASSERT_EQUAL(0.0f, first().real());
+            }
+
+          void test_empty_source_restores_raw_conversion()
+            {
+            dab::rtl_file device{m_queue, kEvenSampleFileName};
+            device.calibrate(dab::conversion::fixed({-1.0f, -0.75f, 2.0f}));
+            device.calibrate(dab::conversion::calibration_source{});
+            device.run();
+
+            ASSERT_EQUAL((dab::internal::sample_t{-1.0f, -0.75f}), first());
+            }
+
+          private:
+            dab::internal::sample_t first()
+              {
+              auto sample = dab::internal::sample_t{};
+              m_queue.try_dequeue(sample);
+              return sample;
+              }
+
+            dab::sample_queue_t m_queue{};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
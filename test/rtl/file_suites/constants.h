@@ -32,6 +32,7 @@
 #ifndef DABDEVICE_TEST_RTL_FILE__CONSTANTS
 #define DABDEVICE_TEST_RTL_FILE__CONSTANTS
 
+#include <cstddef>
 #include <cstdint>
 
 namespace dab
@@ -49,10 +50,14 @@ namespace dab
         auto constexpr kEmptyFileName      = "rtl_file_empty";
         auto constexpr kEvenSampleFileName = "rtl_file_even_sample";
         auto constexpr kOddSampleFileName  = "rtl_file_odd_sample";
+        auto constexpr kPacingFileName     = "rtl_file_pacing";
 
         std::uint8_t constexpr kEvenSampleData[] = {0, 32, 64, 96, 128, 160, 192, 255};
         std::uint8_t constexpr kOddSampleData[]  = {0, 32, 64, 96, 128, 160, 192, 224, 255};
 
+        auto constexpr kPacingBlockSize = std::size_t{4096};
+        auto constexpr kPacingFileSize  = 10 * kPacingBlockSize;
+
         }
 
       }
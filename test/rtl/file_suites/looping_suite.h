@@ -64,6 +64,7 @@ namespace dab
               LOCAL_TEST(test_non_looping_even_4_samples),
               LOCAL_TEST(test_non_looping_odd_4_samples),
               LOCAL_TEST(test_looping_more_samples),
+              LOCAL_TEST(test_stop_right_after_start_ends_looping_replay),
 #undef LOCAL_TEST
             };
             }
@@ -82,6 +83,22 @@ namespace dab
             ASSERT(true);
             }
 
+          void test_stop_right_after_start_ends_looping_replay()
+            {
+            dab::rtl_file device{m_queue, kEvenSampleFileName};
+            device.enable(dab::device::option::loop);
+
+            for(auto round = 1u; round <= 20; ++round)
+              {
+              auto runner = std::async(std::launch::async, [&]{device.run();});
+              device.wait_for_starts(round);
+              device.stop();
+
+              ASSERT(runner.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+              runner.get();
+              }
+            }
+
           void test_non_looping_even_4_samples()
             {
             dab::rtl_file device{m_queue, kEvenSampleFileName};
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__METADATA_SUITE
+#define DABDEVICE_TEST_RTL_FILE__METADATA_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_file.h>
+#include <dab/transport/block_pool.h>
+#include <dab/types/block_metadata.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(metadata_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_blocks_are_numbered_consecutively),
+              LOCAL_TEST(test_first_block_reports_settings),
+              LOCAL_TEST(test_lost_samples_are_accounted_for),
+              LOCAL_TEST(test_blocks_are_timestamped_on_acquisition),
+#undef LOCAL_TEST
+            };
+            }
+
+          static std::vector<dab::block_metadata> receive_all(dab::raw_block_pool & pool)
+            {
+            auto metadata = std::vector<dab::block_metadata>{};
+            auto block = dab::raw_block_pool::block{};
+            while(pool.try_receive(block))
+              {
+              metadata.push_back(block.metadata());
+              }
+            return metadata;
+            }
+
+          void test_blocks_are_numbered_consecutively()
+            {
+            dab::raw_block_pool pool{4, 1};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.run();
+
+            auto const metadata = receive_all(pool);
+            ASSERT_EQUAL(4u, metadata.size());
+            for(auto index = std::size_t{}; index < metadata.size(); ++index)
+              {
+              ASSERT_EQUAL(index, metadata[index].sequence);
+              ASSERT_EQUAL(index, metadata[index].sampleIndex);
+              ASSERT(!metadata[index].has(dab::block_metadata::kDiscontinuity));
+              }
+            }
+
+          void test_first_block_reports_settings()
+            {
+            using namespace dab::literals;
+
+            dab::raw_block_pool pool{2, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.tune(178352_kHz);
+            device.run();
+
+            auto const metadata = receive_all(pool);
+            ASSERT_EQUAL(2u, metadata.size());
+            ASSERT_EQUAL(178352000u, metadata[0].centerFrequency);
+            ASSERT_EQUAL(178352000u, metadata[1].centerFrequency);
+            ASSERT(metadata[0].has(dab::block_metadata::kRetuned));
+            ASSERT(!metadata[1].has(dab::block_metadata::kRetuned));
+            }
+
+          void test_lost_samples_are_accounted_for()
+            {
+            dab::raw_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.overflow(dab::overflow_policy::drop_oldest);
+            device.run();
+
+            auto const metadata = receive_all(pool);
+            ASSERT_EQUAL(1u, metadata.size());
+            ASSERT_EQUAL(1u, metadata[0].sequence);
+            ASSERT_EQUAL(2u, metadata[0].sampleIndex);
+            ASSERT(metadata[0].has(dab::block_metadata::kDiscontinuity));
+            }
+
+          void test_blocks_are_timestamped_on_acquisition()
+            {
+            dab::raw_block_pool pool{4, 1};
+            dab::rtl_file device{pool, kEvenSampleFileName, 2};
+
+            auto const before = std::chrono::steady_clock::now();
+            device.run();
+            auto const after = std::chrono::steady_clock::now();
+
+            auto const metadata = receive_all(pool);
+            ASSERT(before <= metadata.front().captured());
+            ASSERT(metadata.back().captured() <= after);
+            for(auto index = std::size_t{1}; index < metadata.size(); ++index)
+              {
+              ASSERT(metadata[index - 1].timestamp <= metadata[index].timestamp);
+              }
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
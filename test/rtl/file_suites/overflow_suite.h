@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__OVERFLOW_SUITE
+#define DABDEVICE_TEST_RTL_FILE__OVERFLOW_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_file.h>
+#include <dab/transport/block_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(overflow_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_replay_blocks_by_default),
+              LOCAL_TEST(test_drop_newest_keeps_oldest_samples),
+              LOCAL_TEST(test_drop_oldest_keeps_latest_samples),
+              LOCAL_TEST(test_drop_oldest_marks_discontinuity),
+              LOCAL_TEST(test_block_delivers_every_sample),
+              LOCAL_TEST(test_blocked_device_can_be_stopped),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_replay_blocks_by_default()
+            {
+            dab::raw_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+
+            ASSERT(device.overflow() == dab::overflow_policy::block);
+            }
+
+          void test_drop_newest_keeps_oldest_samples()
+            {
+            dab::raw_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.overflow(dab::overflow_policy::drop_newest);
+            device.run();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, block.data(), 4));
+            ASSERT_EQUAL(2u, device.stats().droppedSamples);
+            }
+
+          void test_drop_oldest_keeps_latest_samples()
+            {
+            dab::raw_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.overflow(dab::overflow_policy::drop_oldest);
+            device.run();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData + 4, block.data(), 4));
+            ASSERT_EQUAL(2u, device.stats().droppedSamples);
+            }
+
+          void test_drop_oldest_marks_discontinuity()
+            {
+            dab::raw_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.overflow(dab::overflow_policy::drop_oldest);
+            device.run();
+
+            ASSERT_EQUAL(2u, pool.receive().discontinuity());
+            }
+
+          void test_block_delivers_every_sample()
+            {
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_file device{pool, kEvenSampleFileName, 2};
+            device.overflow(dab::overflow_policy::block);
+            auto replay = std::async(std::launch::async, [&]{ device.run(); });
+
+            auto received = std::vector<std::uint8_t>{};
+            while(received.size() < sizeof(kEvenSampleData))
+              {
+              auto block = pool.receive();
+              ASSERT_EQUAL(0u, block.discontinuity());
+              received.push_back(block[0].inphase);
+              received.push_back(block[0].quadrature);
+              }
+
+            replay.get();
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, received.data(), received.size()));
+            ASSERT_EQUAL(0u, device.stats().droppedSamples);
+            }
+
+          void test_blocked_device_can_be_stopped()
+            {
+            dab::raw_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.overflow(dab::overflow_policy::block);
+            device.enable(dab::device::option::loop);
+            auto replay = std::async(std::launch::async, [&]{ device.run(); });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            device.stop();
+
+            ASSERT(replay.wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+            replay.get();
+            ASSERT_EQUAL(2u, pool.buffered());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__PACING_SUITE
+#define DABDEVICE_TEST_RTL_FILE__PACING_SUITE
+
+#include "constants.h"
+
+#include <dab/device/pacer.h>
+#include <dab/device/rtl_file.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(pacing_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_replay_is_unthrottled_by_default),
+              LOCAL_TEST(test_negative_speed_is_unthrottled),
+              LOCAL_TEST(test_real_time_replay_takes_recording_duration),
+              LOCAL_TEST(test_faster_replay_takes_proportionally_less_time),
+              LOCAL_TEST(test_late_release_is_reported_as_lag),
+              LOCAL_TEST(test_timely_release_has_no_lag),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_replay_is_unthrottled_by_default()
+            {
+            dab::rtl_file device{m_queue, kPacingFileName, kPacingBlockSize};
+
+            ASSERT_EQUAL(dab::pacer::kUnthrottled, device.pacing().speed());
+            }
+
+          void test_negative_speed_is_unthrottled()
+            {
+            dab::pacer pacer{};
+            pacer.speed(-2.0);
+
+            ASSERT_EQUAL(dab::pacer::kUnthrottled, pacer.speed());
+            }
+
+          void test_real_time_replay_takes_recording_duration()
+            {
+            ASSERT(replay(1.0) >= kLastBlockDeadline);
+            }
+
+          void test_faster_replay_takes_proportionally_less_time()
+            {
+            ASSERT(replay(10.0) >= kLastBlockDeadline / 10);
+            }
+
+          void test_late_release_is_reported_as_lag()
+            {
+            dab::pacer pacer{1000};
+            pacer.speed(1.0);
+            pacer.release(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            pacer.release(1);
+
+            ASSERT(pacer.lag() >= std::chrono::milliseconds{15});
+            ASSERT(pacer.max_lag() >= pacer.lag());
+            }
+
+          void test_timely_release_has_no_lag()
+            {
+            dab::pacer pacer{1000};
+            pacer.speed(1.0);
+            pacer.release(5);
+            pacer.release(5);
+
+            ASSERT_EQUAL(0, pacer.lag().count());
+            }
+
+          private:
+            // The deadline of the last of 10 blocks of 2048 samples each at 2.048 MSps
+            static std::chrono::microseconds constexpr kLastBlockDeadline{9000};
+
+            std::chrono::microseconds replay(double speed)
+              {
+              dab::rtl_file device{m_queue, kPacingFileName, kPacingBlockSize};
+              device.pace(speed);
+
+              auto const start = std::chrono::steady_clock::now();
+              device.run();
+              return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+              }
+
+            dab::sample_queue_t m_queue{};
+          };
+
+        constexpr std::chrono::microseconds pacing_tests::kLastBlockDeadline;
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
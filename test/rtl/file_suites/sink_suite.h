@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__SINK_SUITE
+#define DABDEVICE_TEST_RTL_FILE__SINK_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_file.h>
+#include <dab/transport/block_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(sink_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_samples_are_delivered_into_pool),
+              LOCAL_TEST(test_blocks_are_split_by_pool_capacity),
+              LOCAL_TEST(test_exhausted_pool_drops_samples),
+              LOCAL_TEST(test_raw_samples_are_delivered_unchanged),
+              LOCAL_TEST(test_raw_samples_ignore_calibration),
+              LOCAL_TEST(test_fixed_samples_are_delivered),
+              LOCAL_TEST(test_fixed_samples_are_calibrated),
+              LOCAL_TEST(test_unsupported_sink_is_rejected),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_samples_are_delivered_into_pool()
+            {
+            dab::sample_block_pool pool{1, 16};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.run();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(4u, block.size());
+            ASSERT_EQUAL((dab::internal::sample_t{-1.0f, -0.75f}), block[0]);
+            }
+
+          void test_blocks_are_split_by_pool_capacity()
+            {
+            dab::sample_block_pool pool{2, 3};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.run();
+
+            ASSERT_EQUAL(3u, pool.receive().size());
+            ASSERT_EQUAL(1u, pool.receive().size());
+            }
+
+          void test_exhausted_pool_drops_samples()
+            {
+            dab::sample_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.overflow(dab::overflow_policy::drop_newest);
+            device.run();
+
+            auto block = pool.receive();
+            auto next = dab::sample_block_pool::block{};
+            ASSERT_EQUAL(2u, block.size());
+            ASSERT(!pool.try_receive(next));
+            }
+
+          void test_raw_samples_are_delivered_unchanged()
+            {
+            dab::raw_block_pool pool{1, 16};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.run();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(4u, block.size());
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, block.data(), sizeof(kEvenSampleData)));
+            }
+
+          void test_raw_samples_ignore_calibration()
+            {
+            dab::raw_block_pool pool{1, 16};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.calibrate(dab::conversion::fixed({-1.0f, -0.75f, 2.0f}));
+            device.run();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, block.data(), sizeof(kEvenSampleData)));
+            }
+
+          void test_fixed_samples_are_delivered()
+            {
+            dab::fixed_block_pool pool{1, 16};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.run();
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(4u, block.size());
+            ASSERT_EQUAL((dab::fixed_sample{-32768, -24576}), block[0]);
+            ASSERT_EQUAL((dab::fixed_sample{16384, 32512}), block[3]);
+            }
+
+          void test_fixed_samples_are_calibrated()
+            {
+            dab::fixed_block_pool pool{1, 16};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.calibrate(dab::conversion::fixed({-1.0f, -0.75f, 2.0f}));
+            device.run();
+
+            ASSERT_EQUAL((dab::fixed_sample{0, 0}), pool.receive()[0]);
+            }
+
+          void test_unsupported_sink_is_rejected()
+            {
+            unsupported_sink sink{};
+            ASSERT_THROWS(dab::rtl_file(sink, kEvenSampleFileName), std::invalid_argument);
+            }
+
+          private:
+            struct unsupported_sink : dab::sink
+              {
+              dab::sample_format format() const override
+                {
+                return static_cast<dab::sample_format>(0xff);
+                }
+              };
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__STATS_SUITE
+#define DABDEVICE_TEST_RTL_FILE__STATS_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_file.h>
+#include <dab/transport/block_pool.h>
+
+#include <dab/types/common_types.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(stats_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_new_device_reports_no_activity),
+              LOCAL_TEST(test_delivered_samples_are_counted),
+              LOCAL_TEST(test_every_block_is_counted),
+              LOCAL_TEST(test_samples_rejected_by_sink_are_counted_as_dropped),
+              LOCAL_TEST(test_high_water_mark_follows_sink),
+              LOCAL_TEST(test_queue_reports_unknown_buffering),
+              LOCAL_TEST(test_callback_durations_are_ordered),
+              LOCAL_TEST(test_idle_time_grows_without_samples),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_new_device_reports_no_activity()
+            {
+            dab::sample_queue_t queue{};
+            dab::rtl_file device{queue, kEvenSampleFileName};
+
+            auto const stats = device.stats();
+            ASSERT_EQUAL(0u, stats.samples);
+            ASSERT_EQUAL(0u, stats.callbacks);
+            ASSERT_EQUAL(0, stats.minCallback.count());
+            ASSERT_EQUAL(0, stats.avgCallback.count());
+            }
+
+          void test_delivered_samples_are_counted()
+            {
+            dab::sample_queue_t queue{};
+            dab::rtl_file device{queue, kEvenSampleFileName};
+            device.run();
+
+            auto const stats = device.stats();
+            ASSERT_EQUAL(4u, stats.samples);
+            ASSERT_EQUAL(1u, stats.blocks);
+            ASSERT_EQUAL(1u, stats.callbacks);
+            ASSERT_EQUAL(0u, stats.droppedBlocks);
+            }
+
+          void test_every_block_is_counted()
+            {
+            dab::sample_queue_t queue{};
+            dab::rtl_file device{queue, kEvenSampleFileName, 4};
+            device.run();
+
+            ASSERT_EQUAL(2u, device.stats().blocks);
+            ASSERT_EQUAL(2u, device.stats().callbacks);
+            }
+
+          void test_samples_rejected_by_sink_are_counted_as_dropped()
+            {
+            dab::sample_block_pool pool{1, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.overflow(dab::overflow_policy::drop_newest);
+            device.run();
+
+            auto const stats = device.stats();
+            ASSERT_EQUAL(2u, stats.samples);
+            ASSERT_EQUAL(1u, stats.droppedBlocks);
+            ASSERT_EQUAL(2u, stats.droppedSamples);
+            }
+
+          void test_high_water_mark_follows_sink()
+            {
+            dab::sample_block_pool pool{2, 2};
+            dab::rtl_file device{pool, kEvenSampleFileName, 4};
+            device.run();
+            pool.receive();
+
+            auto const stats = device.stats();
+            ASSERT_EQUAL(4u, stats.highWaterMark);
+            ASSERT_EQUAL(2 * sizeof(dab::internal::sample_t), stats.bufferedBytes);
+            ASSERT(stats.bufferingKnown);
+            }
+
+          void test_queue_reports_unknown_buffering()
+            {
+            dab::sample_queue_t queue{};
+            dab::rtl_file device{queue, kEvenSampleFileName};
+            device.run();
+
+            auto const stats = device.stats();
+            ASSERT(!stats.bufferingKnown);
+            ASSERT_EQUAL(0u, stats.highWaterMark);
+            ASSERT_EQUAL(0u, stats.bufferedBytes);
+            }
+
+          void test_callback_durations_are_ordered()
+            {
+            dab::sample_queue_t queue{};
+            dab::rtl_file device{queue, kPacingFileName, kPacingBlockSize};
+            device.run();
+
+            auto const stats = device.stats();
+            ASSERT(stats.minCallback <= stats.avgCallback);
+            ASSERT(stats.avgCallback <= stats.maxCallback);
+            ASSERT(stats.conversionTime.count() > 0);
+            }
+
+          void test_idle_time_grows_without_samples()
+            {
+            dab::sample_queue_t queue{};
+            dab::rtl_file device{queue, kEvenSampleFileName};
+            device.run();
+
+            auto const idle = device.stats().idle;
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            ASSERT(device.stats().idle - idle >= std::chrono::milliseconds{5});
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_FILE__THREADING_SUITE
+#define DABDEVICE_TEST_RTL_FILE__THREADING_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_file.h>
+#include <dab/device/thread_options.h>
+#include <dab/transport/block_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <system_error>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(threading_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_default_options_leave_thread_untouched),
+              LOCAL_TEST(test_name_is_applied_to_replay_thread),
+              LOCAL_TEST(test_name_is_restored_after_replay),
+              LOCAL_TEST(test_affinity_is_applied_to_replay_thread),
+              LOCAL_TEST(test_affinity_is_restored_after_replay),
+              LOCAL_TEST(test_invalid_name_is_reported),
+              LOCAL_TEST(test_invalid_cpu_is_reported),
+              LOCAL_TEST(test_invalid_priority_is_reported),
+#undef LOCAL_TEST
+            };
+            }
+
+          /**
+           * @brief Replay the even sample file in a loop with @p options on a fresh thread, and call @p during with
+           * the handle of that thread while it is replaying and @p after once the replay has returned
+           */
+          template<typename During, typename After>
+          static void replay(dab::thread_options const & options, During during, After after)
+            {
+            dab::raw_block_pool pool{1, 4};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.enable(dab::device::option::loop);
+            device.threading(options);
+
+            std::atomic<bool> returned{};
+            std::atomic<bool> inspected{};
+            auto thread = std::thread{[&]{
+              device.run();
+              returned = true;
+              while(!inspected)
+                {
+                std::this_thread::yield();
+                }
+            }};
+
+            // The options are applied before the first block is published
+            while(!pool.buffered())
+              {
+              std::this_thread::yield();
+              }
+            during(thread.native_handle());
+
+            device.stop();
+            while(!returned)
+              {
+              std::this_thread::yield();
+              }
+            after(thread.native_handle());
+
+            inspected = true;
+            thread.join();
+            }
+
+          static std::string name_of(pthread_t const thread)
+            {
+            auto name = std::array<char, 16>{};
+            pthread_getname_np(thread, name.data(), name.size());
+            return name.data();
+            }
+
+          static int nof_cpus_of(pthread_t const thread)
+            {
+            cpu_set_t cpus;
+            pthread_getaffinity_np(thread, sizeof(cpus), &cpus);
+            return CPU_COUNT(&cpus);
+            }
+
+          static std::string current_name()
+            {
+            return name_of(pthread_self());
+            }
+
+          void test_default_options_leave_thread_untouched()
+            {
+            auto const expected = current_name();
+
+            dab::raw_block_pool pool{1, 4};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.run();
+
+            ASSERT_EQUAL(expected, current_name());
+            }
+
+          void test_name_is_applied_to_replay_thread()
+            {
+            auto options = dab::thread_options{};
+            options.name = "dab-replay";
+
+            auto name = std::string{};
+            replay(options, [&](pthread_t thread){ name = name_of(thread); }, [](pthread_t){});
+
+            ASSERT_EQUAL("dab-replay", name);
+            }
+
+          void test_name_is_restored_after_replay()
+            {
+            auto options = dab::thread_options{};
+            options.name = "dab-replay";
+
+            auto name = std::string{};
+            replay(options, [](pthread_t){}, [&](pthread_t thread){ name = name_of(thread); });
+
+            ASSERT_EQUAL(current_name(), name);
+            }
+
+          void test_affinity_is_applied_to_replay_thread()
+            {
+            auto options = dab::thread_options{};
+            options.cpus = {static_cast<unsigned>(sched_getcpu())};
+
+            auto nofCpus = 0;
+            replay(options, [&](pthread_t thread){ nofCpus = nof_cpus_of(thread); }, [](pthread_t){});
+
+            ASSERT_EQUAL(1, nofCpus);
+            }
+
+          void test_affinity_is_restored_after_replay()
+            {
+            auto options = dab::thread_options{};
+            options.cpus = {static_cast<unsigned>(sched_getcpu())};
+
+            auto nofCpus = 0;
+            replay(options, [](pthread_t){}, [&](pthread_t thread){ nofCpus = nof_cpus_of(thread); });
+
+            ASSERT_EQUAL(nof_cpus_of(pthread_self()), nofCpus);
+            }
+
+          void test_invalid_name_is_reported()
+            {
+            auto options = dab::thread_options{};
+            options.name = "a-name-that-is-too-long";
+
+            dab::raw_block_pool pool{1, 4};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.threading(options);
+
+            ASSERT_THROWS(device.run(), std::system_error);
+            ASSERT(!device.running());
+            ASSERT_EQUAL(0u, pool.buffered());
+            }
+
+          void test_invalid_cpu_is_reported()
+            {
+            auto options = dab::thread_options{};
+            options.cpus = {CPU_SETSIZE};
+
+            dab::raw_block_pool pool{1, 4};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.threading(options);
+
+            ASSERT_THROWS(device.run(), std::system_error);
+            }
+
+          void test_invalid_priority_is_reported()
+            {
+            auto options = dab::thread_options{};
+            options.scheduling = dab::scheduling_policy::fifo;
+            options.priority = sched_get_priority_max(SCHED_FIFO) + 1;
+
+            dab::raw_block_pool pool{1, 4};
+            dab::rtl_file device{pool, kEvenSampleFileName};
+            device.threading(options);
+
+            ASSERT_THROWS(device.run(), std::system_error);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
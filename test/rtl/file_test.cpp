@@ -29,10 +29,19 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "file_suites/block_suite.h"
+#include "file_suites/calibration_suite.h"
 #include "file_suites/constants.h"
 #include "file_suites/looping_suite.h"
+#include "file_suites/metadata_suite.h"
 #include "file_suites/normalization_suite.h"
 #include "file_suites/option_suite.h"
+#include "file_suites/overflow_suite.h"
+#include "file_suites/pacing_suite.h"
+#include "file_suites/read_suite.h"
+#include "file_suites/sink_suite.h"
+#include "file_suites/stats_suite.h"
+#include "file_suites/threading_suite.h"
 
 #include <cute/cute.h>
 #include <cute/cute_runner.h>
@@ -45,6 +54,7 @@
 #include <fstream>
 #include <future>
 #include <random>
+#include <string>
 
 using namespace dab::test::rtl::file;
 
@@ -60,6 +70,10 @@ void setup()
   std::ofstream oddSampleFile{kOddSampleFileName, std::ios::binary | std::ios::trunc};
   oddSampleFile.write((char *)kOddSampleData, sizeof(kOddSampleData));
   oddSampleFile.close();
+
+  std::ofstream pacingFile{kPacingFileName, std::ios::binary | std::ios::trunc};
+  pacingFile << std::string(kPacingFileSize, char(128));
+  pacingFile.close();
   }
 
 void teardown()
@@ -67,6 +81,7 @@ void teardown()
   remove(kEmptyFileName);
   remove(kEvenSampleFileName);
   remove(kOddSampleFileName);
+  remove(kPacingFileName);
   }
 
 int main(int argc, char * * argv)
@@ -78,9 +93,18 @@ int main(int argc, char * * argv)
   auto runner = cute::makeRunner(listener, argc, argv);
 
   setup();
+  success &= cute::extensions::runSelfDescriptive<block_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<calibration_tests>(runner);
   success &= cute::extensions::runSelfDescriptive<looping_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<metadata_tests>(runner);
   success &= cute::extensions::runSelfDescriptive<normalization_tests>(runner);
   success &= cute::extensions::runSelfDescriptive<option_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<overflow_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<pacing_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<read_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<sink_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<stats_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<threading_tests>(runner);
   teardown();
 
   return !success;
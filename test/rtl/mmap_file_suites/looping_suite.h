@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_MMAP_FILE__LOOPING_SUITE
+#define DABDEVICE_TEST_RTL_MMAP_FILE__LOOPING_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_mmap_file.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace mmap_file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(looping_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_non_looping_even_4_samples),
+              LOCAL_TEST(test_non_looping_odd_4_samples),
+              LOCAL_TEST(test_non_looping_small_blocks_keep_sample_order),
+              LOCAL_TEST(test_looping_wraps_to_first_sample),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_non_looping_even_4_samples()
+            {
+            dab::rtl_mmap_file device{m_queue, kEvenSampleFileName};
+            device.run();
+
+            ASSERT_EQUAL(4, drain().size());
+            }
+
+          void test_non_looping_odd_4_samples()
+            {
+            dab::rtl_mmap_file device{m_queue, kOddSampleFileName};
+            device.run();
+
+            ASSERT_EQUAL(4, drain().size());
+            }
+
+          void test_non_looping_small_blocks_keep_sample_order()
+            {
+            dab::rtl_mmap_file device{m_queue, kEvenSampleFileName, 6};
+            device.run();
+
+            auto const samples = drain();
+
+            ASSERT_EQUAL(4, samples.size());
+            for(std::size_t idx = 0; idx < samples.size(); ++idx)
+              {
+              ASSERT_EQUAL(expected(kEvenSampleData, idx), samples[idx]);
+              }
+            }
+
+          void test_looping_wraps_to_first_sample()
+            {
+            dab::rtl_mmap_file device{m_queue, kOddSampleFileName, 6};
+            device.enable(dab::device::option::loop);
+
+            auto runner = std::async(std::launch::async, [&]{device.run();});
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+            device.stop();
+
+            runner.get();
+
+            auto const samples = drain();
+
+            ASSERT_LESS(4, samples.size());
+            for(std::size_t idx = 0; idx < samples.size(); ++idx)
+              {
+              ASSERT_EQUAL(expected(kOddSampleData, idx % 4), samples[idx]);
+              }
+            }
+
+          private:
+            std::vector<dab::internal::sample_t> drain()
+              {
+              auto samples = std::vector<dab::internal::sample_t>{};
+              auto sample = dab::internal::sample_t{};
+
+              while(m_queue.try_dequeue(sample))
+                {
+                samples.push_back(sample);
+                }
+
+              return samples;
+              }
+
+            static dab::internal::sample_t expected(std::uint8_t const * data, std::size_t index)
+              {
+              return {(float(data[2 * index]) - 128) / 128, (float(data[2 * index + 1]) - 128) / 128};
+              }
+
+            dab::sample_queue_t m_queue{};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
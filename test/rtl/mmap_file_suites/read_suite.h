@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_RTL_MMAP_FILE__READ_SUITE
+#define DABDEVICE_TEST_RTL_MMAP_FILE__READ_SUITE
+
+#include "constants.h"
+
+#include <dab/device/rtl_mmap_file.h>
+#include <dab/transport/block_pool.h>
+#include <dab/types/fixed_sample.h>
+#include <dab/types/raw_sample.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstring>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace rtl
+      {
+
+      namespace mmap_file
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(read_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_read_returns_file_contents),
+              LOCAL_TEST(test_read_continues_where_previous_read_stopped),
+              LOCAL_TEST(test_read_stops_at_end_of_file),
+              LOCAL_TEST(test_read_wraps_around_when_looping),
+              LOCAL_TEST(test_read_converts_samples),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_read_returns_file_contents()
+            {
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_mmap_file device{pool, kEvenSampleFileName, 2};
+
+            auto samples = std::vector<dab::raw_sample>(4);
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, samples.data(), sizeof(kEvenSampleData)));
+            ASSERT_EQUAL(0u, pool.buffered());
+            }
+
+          void test_read_continues_where_previous_read_stopped()
+            {
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_mmap_file device{pool, kEvenSampleFileName};
+
+            auto samples = std::vector<dab::raw_sample>(4);
+            ASSERT_EQUAL(1u, device.read(samples.data(), 1));
+            ASSERT_EQUAL(3u, device.read(samples.data() + 1, 3));
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, samples.data(), sizeof(kEvenSampleData)));
+            }
+
+          void test_read_stops_at_end_of_file()
+            {
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_mmap_file device{pool, kEvenSampleFileName};
+
+            auto samples = std::vector<dab::raw_sample>(16);
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(0u, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(4u, device.stats().samples);
+            }
+
+          void test_read_wraps_around_when_looping()
+            {
+            dab::raw_block_pool pool{1, 1};
+            dab::rtl_mmap_file device{pool, kEvenSampleFileName};
+            device.enable(dab::device::option::loop);
+
+            auto samples = std::vector<dab::raw_sample>(10);
+            ASSERT_EQUAL(10u, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, samples.data() + 4, sizeof(kEvenSampleData)));
+            ASSERT_EQUAL(0, std::memcmp(kEvenSampleData, samples.data() + 8, 4));
+            }
+
+          void test_read_converts_samples()
+            {
+            dab::fixed_block_pool pool{1, 1};
+            dab::rtl_mmap_file device{pool, kEvenSampleFileName};
+
+            auto samples = std::vector<dab::fixed_sample>(4);
+            ASSERT_EQUAL(4u, device.read(samples.data(), samples.size()));
+            ASSERT_EQUAL(-32768, samples[0].real());
+            ASSERT_EQUAL(32512, samples[3].imag());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
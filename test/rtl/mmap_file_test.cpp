@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mmap_file_suites/constants.h"
+#include "mmap_file_suites/looping_suite.h"
+#include "mmap_file_suites/option_suite.h"
+#include "mmap_file_suites/read_suite.h"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/cute_suite.h>
+#include <cute/xml_listener.h>
+#include <cute/ide_listener.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace dab::test::rtl::mmap_file;
+
+void setup()
+  {
+  std::ofstream emptyFile{kEmptyFileName};
+  emptyFile.close();
+
+  std::ofstream evenSampleFile{kEvenSampleFileName, std::ios::binary | std::ios::trunc};
+  evenSampleFile.write((char *)kEvenSampleData, sizeof(kEvenSampleData));
+  evenSampleFile.close();
+
+  std::ofstream oddSampleFile{kOddSampleFileName, std::ios::binary | std::ios::trunc};
+  oddSampleFile.write((char *)kOddSampleData, sizeof(kOddSampleData));
+  oddSampleFile.close();
+  }
+
+void teardown()
+  {
+  remove(kEmptyFileName);
+  remove(kEvenSampleFileName);
+  remove(kOddSampleFileName);
+  }
+
+int main(int argc, char * * argv)
+  {
+  auto xmlFile = cute::xml_file_opener{argc, argv};
+  auto listener = cute::xml_listener<cute::ide_listener<>>{xmlFile.out};
+
+  auto success = true;
+  auto runner = cute::makeRunner(listener, argc, argv);
+
+  setup();
+  success &= cute::extensions::runSelfDescriptive<looping_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<option_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<read_tests>(runner);
+  teardown();
+
+  return !success;
+  }
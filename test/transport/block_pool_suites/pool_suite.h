@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_TRANSPORT_BLOCK_POOL__POOL_SUITE
+#define DABDEVICE_TEST_TRANSPORT_BLOCK_POOL__POOL_SUITE
+
+#include <dab/transport/block_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace transport
+      {
+
+      namespace block_pool
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(pool_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_empty_pool_is_rejected),
+              LOCAL_TEST(test_committed_block_is_received),
+              LOCAL_TEST(test_reservation_is_limited_to_block_capacity),
+              LOCAL_TEST(test_exhausted_pool_rejects_reservation),
+              LOCAL_TEST(test_released_block_is_reused),
+              LOCAL_TEST(test_steady_state_reuses_storage),
+              LOCAL_TEST(test_moved_block_is_released_once),
+              LOCAL_TEST(test_receive_for_times_out_without_blocks),
+              LOCAL_TEST(test_try_receive_returns_held_block),
+              LOCAL_TEST(test_receive_for_returns_held_block),
+              LOCAL_TEST(test_write_spans_multiple_blocks),
+              LOCAL_TEST(test_buffered_counts_samples_in_ready_blocks),
+              LOCAL_TEST(test_continuous_blocks_report_no_discontinuity),
+              LOCAL_TEST(test_discontinuity_is_reported_by_next_block),
+              LOCAL_TEST(test_blocks_carry_reported_center_frequency),
+              LOCAL_TEST(test_metadata_is_completed_per_block),
+              LOCAL_TEST(test_lost_samples_advance_sample_index),
+              LOCAL_TEST(test_discarded_blocks_leave_sequence_gap),
+              LOCAL_TEST(test_discard_oldest_reclaims_ready_block),
+              LOCAL_TEST(test_discarded_samples_are_reported_by_next_block),
+              LOCAL_TEST(test_discard_oldest_fails_without_ready_blocks),
+              LOCAL_TEST(test_wait_for_room_times_out_while_exhausted),
+              LOCAL_TEST(test_wait_for_room_wakes_up_on_release),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_empty_pool_is_rejected()
+            {
+            ASSERT_THROWS(dab::sample_block_pool(0, 16), std::invalid_argument);
+            ASSERT_THROWS(dab::sample_block_pool(4, 0), std::invalid_argument);
+            }
+
+          void test_committed_block_is_received()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 3);
+
+            auto block = pool.receive();
+            ASSERT_EQUAL(3u, block.size());
+            ASSERT_EQUAL((dab::internal::sample_t{2.0f, 0.0f}), block[2]);
+            }
+
+          void test_reservation_is_limited_to_block_capacity()
+            {
+            dab::sample_block_pool pool{1, 4};
+            auto count = std::size_t{16};
+
+            ASSERT(pool.reserve(count));
+            ASSERT_EQUAL(4u, count);
+            }
+
+          void test_exhausted_pool_rejects_reservation()
+            {
+            dab::sample_block_pool pool{1, 4};
+            publish(pool, 1);
+            auto count = std::size_t{4};
+
+            ASSERT(!pool.reserve(count));
+            ASSERT_EQUAL(0u, count);
+            }
+
+          void test_released_block_is_reused()
+            {
+            dab::sample_block_pool pool{1, 4};
+            publish(pool, 1);
+            pool.receive().release();
+
+            ASSERT_EQUAL(1u, pool.available());
+            ASSERT_EQUAL(4u, publish(pool, 4));
+            }
+
+          void test_steady_state_reuses_storage()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            auto const first = pool.receive().data();
+            publish(pool, 4);
+            publish(pool, 4);
+            pool.receive();
+
+            ASSERT_EQUAL(first, pool.receive().data());
+            }
+
+          void test_moved_block_is_released_once()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 1);
+
+              {
+              auto block = pool.receive();
+              auto other = std::move(block);
+              ASSERT(!block);
+              ASSERT(other);
+              ASSERT_EQUAL(1u, pool.available());
+              }
+
+            ASSERT_EQUAL(2u, pool.available());
+            }
+
+          void test_receive_for_times_out_without_blocks()
+            {
+            dab::sample_block_pool pool{1, 4};
+            auto block = dab::sample_block_pool::block{};
+
+            ASSERT(!pool.receive_for(block, std::chrono::milliseconds{1}));
+            ASSERT(!block);
+            }
+
+          void test_try_receive_returns_held_block()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            publish(pool, 4);
+
+            auto block = dab::sample_block_pool::block{};
+            ASSERT(pool.try_receive(block));
+            ASSERT(pool.try_receive(block));
+            ASSERT_EQUAL(1u, pool.available());
+            }
+
+          void test_receive_for_returns_held_block()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            publish(pool, 4);
+
+            auto block = dab::sample_block_pool::block{};
+            ASSERT(pool.receive_for(block, std::chrono::milliseconds{10}));
+            ASSERT(pool.receive_for(block, std::chrono::milliseconds{10}));
+            ASSERT_EQUAL(1u, pool.available());
+            }
+
+          void test_write_spans_multiple_blocks()
+            {
+            dab::sample_block_pool pool{3, 4};
+            dab::internal::sample_t const samples[10]{};
+
+            ASSERT_EQUAL(10u, pool.write(samples, 10));
+            ASSERT_EQUAL(4u, pool.receive().size());
+            ASSERT_EQUAL(4u, pool.receive().size());
+            ASSERT_EQUAL(2u, pool.receive().size());
+            }
+
+          void test_buffered_counts_samples_in_ready_blocks()
+            {
+            dab::sample_block_pool pool{3, 4};
+            publish(pool, 4);
+            publish(pool, 2);
+            ASSERT_EQUAL(6u, pool.buffered());
+
+            pool.receive();
+            ASSERT_EQUAL(2u, pool.buffered());
+            }
+
+          void test_continuous_blocks_report_no_discontinuity()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            publish(pool, 4);
+
+            ASSERT_EQUAL(0u, pool.receive().discontinuity());
+            ASSERT_EQUAL(0u, pool.receive().discontinuity());
+            }
+
+          void test_discontinuity_is_reported_by_next_block()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            pool.discontinuity(7);
+            publish(pool, 4);
+
+            ASSERT_EQUAL(0u, pool.receive().discontinuity());
+            ASSERT_EQUAL(7u, pool.receive().discontinuity());
+            }
+
+          void test_blocks_carry_reported_center_frequency()
+            {
+            using namespace dab::literals;
+
+            dab::sample_block_pool pool{3, 4};
+            publish(pool, 4);
+            pool.retuned(178352_kHz);
+            publish(pool, 4);
+            publish(pool, 4);
+
+            ASSERT_EQUAL(0u, std::uint32_t(pool.receive().center_frequency()));
+            ASSERT_EQUAL(178352000u, std::uint32_t(pool.receive().center_frequency()));
+            ASSERT_EQUAL(178352000u, std::uint32_t(pool.receive().center_frequency()));
+            }
+
+          void test_metadata_is_completed_per_block()
+            {
+            dab::sample_block_pool pool{3, 4};
+            pool.acquired(dab::block_metadata{0, 100, 5, 178352000, 20.0f, dab::block_metadata::kRetuned});
+            auto const samples = std::vector<dab::internal::sample_t>(10);
+            pool.write(samples.data(), samples.size());
+
+            for(auto index = std::uint64_t{}; index < 3; ++index)
+              {
+              auto const metadata = pool.receive().metadata();
+              ASSERT_EQUAL(index, metadata.sequence);
+              ASSERT_EQUAL(100 + 4 * index, metadata.sampleIndex);
+              ASSERT_EQUAL(5, metadata.timestamp);
+              ASSERT_EQUAL(178352000u, metadata.centerFrequency);
+              ASSERT_EQUAL(20.0f, metadata.gain);
+              ASSERT_EQUAL(index == 0, metadata.has(dab::block_metadata::kRetuned));
+              }
+            }
+
+          void test_lost_samples_advance_sample_index()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            pool.discontinuity(6);
+            publish(pool, 4);
+
+            ASSERT_EQUAL(0u, pool.receive().metadata().sampleIndex);
+            auto const metadata = pool.receive().metadata();
+            ASSERT_EQUAL(10u, metadata.sampleIndex);
+            ASSERT(metadata.has(dab::block_metadata::kDiscontinuity));
+            }
+
+          void test_discarded_blocks_leave_sequence_gap()
+            {
+            dab::sample_block_pool pool{2, 4};
+            publish(pool, 4);
+            publish(pool, 4);
+            pool.discard_oldest();
+            publish(pool, 4);
+
+            auto const first = pool.receive().metadata();
+            auto const second = pool.receive().metadata();
+            ASSERT_EQUAL(1u, first.sequence);
+            ASSERT_EQUAL(4u, first.sampleIndex);
+            ASSERT(first.has(dab::block_metadata::kDiscontinuity));
+            ASSERT_EQUAL(2u, second.sequence);
+            ASSERT(!second.has(dab::block_metadata::kDiscontinuity));
+            }
+
+          void test_discard_oldest_reclaims_ready_block()
+            {
+            dab::sample_block_pool pool{1, 4};
+            publish(pool, 3);
+
+            ASSERT_EQUAL(3u, pool.discard_oldest());
+            ASSERT_EQUAL(1u, pool.available());
+            ASSERT_EQUAL(0u, pool.buffered());
+            }
+
+          void test_discarded_samples_are_reported_by_next_block()
+            {
+            dab::sample_block_pool pool{3, 4};
+            publish(pool, 4);
+            publish(pool, 2);
+            pool.discard_oldest();
+            publish(pool, 4);
+            pool.discard_oldest();
+
+            auto const block = pool.receive();
+            ASSERT_EQUAL(4u, block.size());
+            ASSERT_EQUAL(6u, block.discontinuity());
+            }
+
+          void test_discard_oldest_fails_without_ready_blocks()
+            {
+            dab::sample_block_pool pool{1, 4};
+
+            ASSERT_EQUAL(0u, pool.discard_oldest());
+            }
+
+          void test_wait_for_room_times_out_while_exhausted()
+            {
+            dab::sample_block_pool pool{1, 4};
+            publish(pool, 4);
+
+            ASSERT(!pool.wait_for_room(std::chrono::milliseconds{1}));
+            }
+
+          void test_wait_for_room_wakes_up_on_release()
+            {
+            dab::sample_block_pool pool{1, 4};
+            publish(pool, 4);
+            auto consumer = std::thread{[&]{ pool.receive(); }};
+
+            ASSERT(pool.wait_for_room(std::chrono::seconds{5}));
+            consumer.join();
+            }
+
+          private:
+            static std::size_t publish(dab::sample_block_pool & pool, std::size_t count)
+              {
+              auto const target = pool.reserve(count);
+              for(std::size_t index = 0; index < count; ++index)
+                {
+                target[index] = dab::internal::sample_t{float(index), 0.0f};
+                }
+              pool.commit(count);
+              return count;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_TRANSPORT_RAW_RECORDER__RECORDER_SUITE
+#define DABDEVICE_TEST_TRANSPORT_RAW_RECORDER__RECORDER_SUITE
+
+#include <dab/transport/raw_recorder.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace transport
+      {
+
+      namespace raw_recorder
+        {
+
+        auto constexpr kPrefix = "raw_recorder_test";
+
+        CUTE_DESCRIPTIVE_STRUCT(recorder_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_unaligned_write_size_is_rejected),
+              LOCAL_TEST(test_buffer_smaller_than_write_is_rejected),
+              LOCAL_TEST(test_unopenable_file_is_reported),
+              LOCAL_TEST(test_recorded_bytes_are_written_unchanged),
+              LOCAL_TEST(test_files_rotate_before_exceeding_size_limit),
+              LOCAL_TEST(test_direct_io_records_all_bytes),
+              LOCAL_TEST(test_overflowing_bytes_are_dropped),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_unaligned_write_size_is_rejected()
+            {
+            auto options = dab::recording_options{kPrefix};
+            options.writeSize = 1000;
+
+            ASSERT_THROWS(dab::raw_recorder{options}, std::invalid_argument);
+            }
+
+          void test_buffer_smaller_than_write_is_rejected()
+            {
+            auto options = dab::recording_options{kPrefix};
+            options.bufferSize = options.writeSize / 2;
+
+            ASSERT_THROWS(dab::raw_recorder{options}, std::invalid_argument);
+            }
+
+          void test_unopenable_file_is_reported()
+            {
+            ASSERT_THROWS(dab::raw_recorder{dab::recording_options{"/nonexistent/directory/recording"}}, std::system_error);
+            }
+
+          void test_recorded_bytes_are_written_unchanged()
+            {
+            auto const bytes = pattern(10000);
+              {
+              dab::raw_recorder recorder{small(kPrefix)};
+              recorder.record(bytes.data(), 6000);
+              recorder.record(bytes.data() + 6000, 4000);
+              }
+
+            ASSERT(bytes == contents(0));
+            cleanup(1);
+            }
+
+          void test_files_rotate_before_exceeding_size_limit()
+            {
+            auto options = small(kPrefix);
+            options.maxFileSize = 8192;
+            auto const bytes = pattern(20000);
+              {
+              dab::raw_recorder recorder{options};
+              recorder.record(bytes.data(), bytes.size());
+              }
+
+            ASSERT_EQUAL(8192u, contents(0).size());
+            ASSERT_EQUAL(8192u, contents(1).size());
+            ASSERT((std::vector<std::uint8_t>(bytes.begin() + 16384, bytes.end())) == contents(2));
+            cleanup(3);
+            }
+
+          void test_direct_io_records_all_bytes()
+            {
+            auto options = small(kPrefix);
+            options.directIo = true;
+            auto const bytes = pattern(10000);
+              {
+              dab::raw_recorder recorder{options};
+              recorder.record(bytes.data(), bytes.size());
+              }
+
+            ASSERT(bytes == contents(0));
+            cleanup(1);
+            }
+
+          void test_overflowing_bytes_are_dropped()
+            {
+            auto options = small(kPrefix);
+            options.bufferSize = 8192;
+            auto const bytes = pattern(65536);
+
+            dab::raw_recorder recorder{options};
+            recorder.record(bytes.data(), bytes.size());
+
+            ASSERT(recorder.dropped() >= bytes.size() - options.bufferSize);
+            cleanup(1);
+            }
+
+          private:
+            static dab::recording_options small(std::string const & prefix)
+              {
+              auto options = dab::recording_options{prefix};
+              options.bufferSize = 65536;
+              options.writeSize = 4096;
+              return options;
+              }
+
+            static std::vector<std::uint8_t> pattern(std::size_t size)
+              {
+              auto bytes = std::vector<std::uint8_t>(size);
+              for(std::size_t index = 0; index < size; ++index)
+                {
+                bytes[index] = static_cast<std::uint8_t>(index * 31 + index / 256);
+                }
+              return bytes;
+              }
+
+            static std::string name(std::size_t sequence)
+              {
+              char suffix[16];
+              std::snprintf(suffix, sizeof(suffix), "-%06zu.raw", sequence);
+              return std::string{kPrefix} + suffix;
+              }
+
+            static std::vector<std::uint8_t> contents(std::size_t sequence)
+              {
+              std::ifstream file{name(sequence), std::ios::binary};
+              return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+              }
+
+            static void cleanup(std::size_t nofFiles)
+              {
+              for(std::size_t sequence = 0; sequence < nofFiles; ++sequence)
+                {
+                std::remove(name(sequence).c_str());
+                }
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
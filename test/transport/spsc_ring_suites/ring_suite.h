@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_TRANSPORT_SPSC_RING__RING_SUITE
+#define DABDEVICE_TEST_TRANSPORT_SPSC_RING__RING_SUITE
+
+#include <dab/transport/spsc_ring.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace transport
+      {
+
+      namespace spsc_ring
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(ring_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_empty_ring_is_rejected),
+              LOCAL_TEST(test_capacity_is_rounded_to_power_of_two),
+              LOCAL_TEST(test_committed_samples_are_readable),
+              LOCAL_TEST(test_uncommitted_samples_are_not_readable),
+              LOCAL_TEST(test_full_ring_rejects_reservation),
+              LOCAL_TEST(test_reservation_stops_at_end_of_storage),
+              LOCAL_TEST(test_read_wraps_around_end_of_storage),
+              LOCAL_TEST(test_read_is_limited_to_target_size),
+              LOCAL_TEST(test_closed_ring_is_drained_before_reporting_end),
+              LOCAL_TEST(test_buffered_counts_unread_samples),
+              LOCAL_TEST(test_read_stops_at_gap),
+              LOCAL_TEST(test_gap_is_reported_with_following_samples),
+              LOCAL_TEST(test_excess_gaps_are_merged),
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_empty_ring_is_rejected()
+            {
+            ASSERT_THROWS(dab::sample_ring{0}, std::invalid_argument);
+            }
+
+          void test_capacity_is_rounded_to_power_of_two()
+            {
+            ASSERT_EQUAL(8u, dab::sample_ring{5}.capacity());
+            ASSERT_EQUAL(8u, dab::sample_ring{8}.capacity());
+            }
+
+          void test_committed_samples_are_readable()
+            {
+            dab::sample_ring ring{8};
+            publish(ring, 3, 0);
+
+            dab::internal::sample_t target[8]{};
+            ASSERT_EQUAL(3u, ring.try_read(target, 8));
+            ASSERT_EQUAL((dab::internal::sample_t{2.0f, 0.0f}), target[2]);
+            }
+
+          void test_uncommitted_samples_are_not_readable()
+            {
+            dab::sample_ring ring{8};
+            auto count = std::size_t{4};
+            ring.reserve(count);
+
+            ASSERT_EQUAL(0u, ring.readable());
+            }
+
+          void test_full_ring_rejects_reservation()
+            {
+            dab::sample_ring ring{4};
+            publish(ring, 4, 0);
+            auto count = std::size_t{1};
+
+            ASSERT(!ring.reserve(count));
+            ASSERT_EQUAL(0u, count);
+            }
+
+          void test_reservation_stops_at_end_of_storage()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[8]{};
+            publish(ring, 6, 0);
+            ring.try_read(target, 6);
+            auto count = std::size_t{8};
+
+            ASSERT(ring.reserve(count));
+            ASSERT_EQUAL(2u, count);
+            }
+
+          void test_read_wraps_around_end_of_storage()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[8]{};
+            publish(ring, 6, 0);
+            ring.try_read(target, 6);
+            publish(ring, 2, 6);
+            publish(ring, 2, 8);
+
+            ASSERT_EQUAL(4u, ring.try_read(target, 8));
+            ASSERT_EQUAL((dab::internal::sample_t{6.0f, 0.0f}), target[0]);
+            ASSERT_EQUAL((dab::internal::sample_t{9.0f, 0.0f}), target[3]);
+            }
+
+          void test_read_is_limited_to_target_size()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[2]{};
+            publish(ring, 5, 0);
+
+            ASSERT_EQUAL(2u, ring.read(target, 2));
+            ASSERT_EQUAL(3u, ring.readable());
+            }
+
+          void test_closed_ring_is_drained_before_reporting_end()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[8]{};
+            publish(ring, 2, 0);
+            ring.close();
+
+            ASSERT_EQUAL(2u, ring.read(target, 8));
+            ASSERT_EQUAL(0u, ring.read(target, 8));
+            }
+
+          void test_buffered_counts_unread_samples()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[8]{};
+            publish(ring, 5, 0);
+            ring.try_read(target, 2);
+
+            ASSERT_EQUAL(3u, ring.buffered());
+            }
+
+          void test_read_stops_at_gap()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[8]{};
+            publish(ring, 2, 0);
+            ring.discontinuity(3);
+            publish(ring, 2, 5);
+
+            ASSERT_EQUAL(2u, ring.try_read(target, 8));
+            ASSERT_EQUAL(0u, ring.last_discontinuity());
+            }
+
+          void test_gap_is_reported_with_following_samples()
+            {
+            dab::sample_ring ring{8};
+            dab::internal::sample_t target[8]{};
+            publish(ring, 2, 0);
+            ring.discontinuity(3);
+            publish(ring, 2, 5);
+            ring.try_read(target, 8);
+
+            ASSERT_EQUAL(2u, ring.try_read(target, 8));
+            ASSERT_EQUAL(3u, ring.last_discontinuity());
+            ASSERT_EQUAL((dab::internal::sample_t{5.0f, 0.0f}), target[0]);
+            }
+
+          void test_excess_gaps_are_merged()
+            {
+            dab::sample_ring ring{dab::sample_ring::kGapCapacity * 2};
+            dab::internal::sample_t target[dab::sample_ring::kGapCapacity * 2]{};
+            for(std::size_t gap = 0; gap < dab::sample_ring::kGapCapacity + 2; ++gap)
+              {
+              ring.discontinuity(1);
+              publish(ring, 1, gap);
+              }
+
+            auto lost = std::size_t{};
+            while(ring.try_read(target, 1))
+              {
+              lost += ring.last_discontinuity();
+              }
+            lost += ring.last_discontinuity();
+
+            ASSERT_EQUAL(dab::sample_ring::kGapCapacity + 2, lost);
+            }
+
+          private:
+            static void publish(dab::sample_ring & ring, std::size_t count, std::size_t first)
+              {
+              auto const target = ring.reserve(count);
+              for(std::size_t index = 0; index < count; ++index)
+                {
+                target[index] = dab::internal::sample_t{float(first + index), 0.0f};
+                }
+              ring.commit(count);
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
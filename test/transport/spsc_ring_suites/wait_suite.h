@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_TRANSPORT_SPSC_RING__WAIT_SUITE
+#define DABDEVICE_TEST_TRANSPORT_SPSC_RING__WAIT_SUITE
+
+#include <dab/transport/spsc_ring.h>
+#include <dab/transport/wait_strategy.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace transport
+      {
+
+      namespace spsc_ring
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(wait_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_spin_wait_transfers_all_samples_in_order),
+              LOCAL_TEST(test_spin_then_park_wait_transfers_all_samples_in_order),
+              LOCAL_TEST(test_poll_wait_transfers_all_samples_in_order),
+#if defined(__linux__)
+              LOCAL_TEST(test_futex_wait_transfers_all_samples_in_order),
+#endif
+#undef LOCAL_TEST
+            };
+            }
+
+          void test_spin_wait_transfers_all_samples_in_order()
+            {
+            ASSERT(transfer<dab::spin_wait>());
+            }
+
+          void test_spin_then_park_wait_transfers_all_samples_in_order()
+            {
+            ASSERT(transfer<dab::spin_then_park_wait>());
+            }
+
+          void test_poll_wait_transfers_all_samples_in_order()
+            {
+            ASSERT(transfer<dab::poll_wait>());
+            }
+
+#if defined(__linux__)
+          void test_futex_wait_transfers_all_samples_in_order()
+            {
+            ASSERT(transfer<dab::futex_wait>());
+            }
+#endif
+
+          private:
+            static std::size_t constexpr kNofSamples = 1 << 16;
+
+            template<typename WaitStrategy>
+            static bool transfer()
+              {
+              dab::basic_spsc_ring<dab::internal::sample_t, WaitStrategy> ring{1024};
+
+              auto producer = std::thread{[&]{
+                auto next = std::size_t{};
+                while(next < kNofSamples)
+                  {
+                  auto count = std::min<std::size_t>(kNofSamples - next, 100);
+                  auto const target = ring.reserve(count);
+                  if(!target)
+                    {
+                    std::this_thread::yield();
+                    continue;
+                    }
+
+                  for(std::size_t index = 0; index < count; ++index)
+                    {
+                    target[index] = dab::internal::sample_t{float(next++), 0.0f};
+                    }
+                  ring.commit(count);
+                  }
+                ring.close();
+              }};
+
+              auto expected = std::size_t{};
+              auto ordered = true;
+              auto buffer = std::vector<dab::internal::sample_t>(256);
+              while(auto const count = ring.read(buffer.data(), buffer.size()))
+                {
+                for(std::size_t index = 0; index < count; ++index)
+                  {
+                  ordered &= buffer[index].real() == float(expected++);
+                  }
+                }
+
+              producer.join();
+              return ordered && expected == kNofSamples;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABDEVICE_TEST_TYPES_GAIN__CLOSEST_SUITE
+#define DABDEVICE_TEST_TYPES_GAIN__CLOSEST_SUITE
+
+#include <dab/types/gain.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace types
+      {
+
+      namespace gain
+        {
+
+        using namespace dab::literals;
+
+        CUTE_DESCRIPTIVE_STRUCT(closest_tests)
+          {
+          static cute::suite suite()
+            {
+            return {
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(descriptive_suite_type, Test)
+              LOCAL_TEST(test_empty_gains_yield_target),
+              LOCAL_TEST(test_exact_gain_is_selected),
+              LOCAL_TEST(test_nearest_gain_is_selected),
+              LOCAL_TEST(test_out_of_range_target_is_clamped),
+              LOCAL_TEST(test_tie_selects_first_gain),
+#undef LOCAL_TEST
+            };
+            }
+
+          std::vector<dab::gain> const gains{0.0_dB, 9.0_dB, 14.0_dB, 27.0_dB, 37.0_dB};
+
+          void test_empty_gains_yield_target()
+            {
+            ASSERT_EQUAL(12.5f, dab::closest_gain({}, 12.5_dB).value());
+            }
+
+          void test_exact_gain_is_selected()
+            {
+            ASSERT_EQUAL(14.0f, dab::closest_gain(gains, 14.0_dB).value());
+            }
+
+          void test_nearest_gain_is_selected()
+            {
+            ASSERT_EQUAL(9.0f, dab::closest_gain(gains, 10.0_dB).value());
+            ASSERT_EQUAL(27.0f, dab::closest_gain(gains, 25.0_dB).value());
+            }
+
+          void test_out_of_range_target_is_clamped()
+            {
+            ASSERT_EQUAL(0.0f, dab::closest_gain(gains, dab::gain{-5.0f}).value());
+            ASSERT_EQUAL(37.0f, dab::closest_gain(gains, 50.0_dB).value());
+            }
+
+          void test_tie_selects_first_gain()
+            {
+            ASSERT_EQUAL(27.0f, dab::closest_gain(gains, 32.0_dB).value());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif